@@ -16,15 +16,21 @@
 
 CC=cc
 PREFIX=/usr/local
-OBJS=src/compilers/compiler-c/main.o src/compilers/compiler-c/embeds/structures.o src/compilers/compiler-c/embeds/functions.o src/compilers/compiler-c/embeds/macro_functions.o src/compilers/compiler-c/embeds/constants.o src/compilers/compiler-m4/main.o src/compilers/compiler-m4/embeds/macro_functions.o src/backends/manpage/main.o src/common/errors/errors.o src/common/parsing/parsing.o src/extractors/extractor-c/main.o src/extractors/extractor-m4/main.o src/deps/cstring/cstring.o src/deps/argparse/argparse.o src/deps/argparse/extract.o src/deps/argparse/ap_inter.o 
-BINS=src/compilers/compiler-c/main src/compilers/compiler-m4/main src/backends/manpage/main src/extractors/extractor-c/main src/extractors/extractor-m4/main 
-DEPS=src/compilers/compiler-c/embeds/structures.o src/compilers/compiler-c/embeds/functions.o src/compilers/compiler-c/embeds/macro_functions.o src/compilers/compiler-c/embeds/constants.o src/compilers/compiler-m4/embeds/macro_functions.o src/common/errors/errors.o src/common/parsing/parsing.o src/deps/cstring/cstring.o src/deps/argparse/argparse.o src/deps/argparse/extract.o src/deps/argparse/ap_inter.o 
+LDLIBS=-lpthread
+DOCFLAGS=--section 3
+OBJS=src/compilers/compiler-c/main.o src/compilers/compiler-c/embeds/structures.o src/compilers/compiler-c/embeds/functions.o src/compilers/compiler-c/embeds/macro_functions.o src/compilers/compiler-c/embeds/constants.o src/compilers/compiler-c/embeds/requests.o src/compilers/compiler-m4/main.o src/compilers/compiler-m4/embeds/macro_functions.o src/backends/manpage/main.o src/common/errors/errors.o src/common/parsing/parsing.o src/common/intern/intern.o src/common/index/index.o src/extractors/extractor-c/main.o src/extractors/extractor-m4/main.o src/deps/cstring/cstring.o src/deps/argparse/argparse.o src/deps/argparse/extract.o src/deps/argparse/ap_inter.o src/tools/apropos/main.o 
+BINS=src/compilers/compiler-c/main src/compilers/compiler-m4/main src/backends/manpage/main src/extractors/extractor-c/main src/extractors/extractor-m4/main src/tools/apropos/main 
+DEPS=src/compilers/compiler-c/embeds/structures.o src/compilers/compiler-c/embeds/functions.o src/compilers/compiler-c/embeds/macro_functions.o src/compilers/compiler-c/embeds/constants.o src/compilers/compiler-c/embeds/requests.o src/compilers/compiler-m4/embeds/macro_functions.o src/common/errors/errors.o src/common/parsing/parsing.o src/common/intern/intern.o src/common/index/index.o src/deps/cstring/cstring.o src/deps/argparse/argparse.o src/deps/argparse/extract.o src/deps/argparse/ap_inter.o 
+TESTS=tests/archive.out tests/backend_stream.out tests/blocks.out tests/check.out tests/demand.out tests/depfile.out tests/embeds.out tests/files.out tests/formats.out tests/index.out tests/jobs.out tests/lines.out tests/only.out tests/pipeline.out tests/serve.out tests/snapshot.out tests/source.out tests/stream.out 
 
 all: $(OBJS) $(BINS)
 
 clean:
 	rm -f $(OBJS)
 	rm -f $(BINS)
+	rm -f $(DOCS)
+	rm -f $(TESTS)
+	rm -rf tests/work
 
 install:
 	cp src/backends/manpage/main $(PREFIX)/bin/docgen-backend-manpage
@@ -32,6 +38,10 @@ install:
 	cp src/compilers/compiler-m4/main $(PREFIX)/bin/docgen-compiler-m4
 	cp src/extractors/extractor-c/main $(PREFIX)/bin/docgen-extractor-c
 	cp src/extractors/extractor-m4/main $(PREFIX)/bin/docgen-extractor-m4
+	cp src/tools/apropos/main $(PREFIX)/bin/docgen-apropos
+
+check: all $(TESTS)
+	./scripts/check.sh
 
 .SUFFIXES:
 
@@ -52,6 +62,8 @@ src/compilers/compiler-c/embeds/macro_functions.o: src/compilers/compiler-c/embe
 	$(CC) -c src/compilers/compiler-c/embeds/macro_functions.c -o src/compilers/compiler-c/embeds/macro_functions.o
 src/compilers/compiler-c/embeds/constants.o: src/compilers/compiler-c/embeds/constants.c 
 	$(CC) -c src/compilers/compiler-c/embeds/constants.c -o src/compilers/compiler-c/embeds/constants.o
+src/compilers/compiler-c/embeds/requests.o: src/compilers/compiler-c/embeds/requests.c 
+	$(CC) -c src/compilers/compiler-c/embeds/requests.c -o src/compilers/compiler-c/embeds/requests.o
 src/compilers/compiler-m4/main.o: src/compilers/compiler-m4/main.c 
 	$(CC) -c src/compilers/compiler-m4/main.c -o src/compilers/compiler-m4/main.o
 src/compilers/compiler-m4/embeds/macro_functions.o: src/compilers/compiler-m4/embeds/macro_functions.c 
@@ -62,6 +74,10 @@ src/common/errors/errors.o: src/common/errors/errors.c
 	$(CC) -c src/common/errors/errors.c -o src/common/errors/errors.o
 src/common/parsing/parsing.o: src/common/parsing/parsing.c 
 	$(CC) -c src/common/parsing/parsing.c -o src/common/parsing/parsing.o
+src/common/intern/intern.o: src/common/intern/intern.c 
+	$(CC) -c src/common/intern/intern.c -o src/common/intern/intern.o
+src/common/index/index.o: src/common/index/index.c 
+	$(CC) -c src/common/index/index.c -o src/common/index/index.o
 src/extractors/extractor-c/main.o: src/extractors/extractor-c/main.c 
 	$(CC) -c src/extractors/extractor-c/main.c -o src/extractors/extractor-c/main.o
 src/extractors/extractor-m4/main.o: src/extractors/extractor-m4/main.c 
@@ -74,16 +90,64 @@ src/deps/argparse/extract.o: src/deps/argparse/extract.c
 	$(CC) -c src/deps/argparse/extract.c -o src/deps/argparse/extract.o
 src/deps/argparse/ap_inter.o: src/deps/argparse/ap_inter.c 
 	$(CC) -c src/deps/argparse/ap_inter.c -o src/deps/argparse/ap_inter.o
-
-src/extractors/extractor-c/main: src/extractors/extractor-c/main.o 
-	$(CC) src/extractors/extractor-c/main.o $(DEPS) -o src/extractors/extractor-c/main
-src/extractors/extractor-m4/main: src/extractors/extractor-m4/main.o 
-	$(CC) src/extractors/extractor-m4/main.o $(DEPS) -o src/extractors/extractor-m4/main
-src/compilers/compiler-c/main: src/compilers/compiler-c/main.o 
-	$(CC) src/compilers/compiler-c/main.o $(DEPS) -o src/compilers/compiler-c/main
-src/compilers/compiler-m4/main: src/compilers/compiler-m4/main.o 
-	$(CC) src/compilers/compiler-m4/main.o $(DEPS) -o src/compilers/compiler-m4/main
-src/backends/manpage/main: src/backends/manpage/main.o 
-	$(CC) src/backends/manpage/main.o $(DEPS) -o src/backends/manpage/main
-
-.PHONY: all clean install
+src/tools/apropos/main.o: src/tools/apropos/main.c 
+	$(CC) -c src/tools/apropos/main.c -o src/tools/apropos/main.o
+
+src/extractors/extractor-c/main: src/extractors/extractor-c/main.o $(DEPS)
+	$(CC) src/extractors/extractor-c/main.o $(DEPS) -o src/extractors/extractor-c/main $(LDLIBS)
+src/extractors/extractor-m4/main: src/extractors/extractor-m4/main.o $(DEPS)
+	$(CC) src/extractors/extractor-m4/main.o $(DEPS) -o src/extractors/extractor-m4/main $(LDLIBS)
+src/compilers/compiler-c/main: src/compilers/compiler-c/main.o $(DEPS)
+	$(CC) src/compilers/compiler-c/main.o $(DEPS) -o src/compilers/compiler-c/main $(LDLIBS)
+src/compilers/compiler-m4/main: src/compilers/compiler-m4/main.o $(DEPS)
+	$(CC) src/compilers/compiler-m4/main.o $(DEPS) -o src/compilers/compiler-m4/main $(LDLIBS)
+src/backends/manpage/main: src/backends/manpage/main.o $(DEPS)
+	$(CC) src/backends/manpage/main.o $(DEPS) -o src/backends/manpage/main $(LDLIBS)
+src/tools/apropos/main: src/tools/apropos/main.o $(DEPS)
+	$(CC) src/tools/apropos/main.o $(DEPS) -o src/tools/apropos/main $(LDLIBS)
+
+tests/stream.out: tests/stream.c tests/common.h
+	$(CC) tests/stream.c -o tests/stream.out
+tests/backend_stream.out: tests/backend_stream.c tests/common.h
+	$(CC) tests/backend_stream.c -o tests/backend_stream.out
+tests/source.out: tests/source.c tests/common.h
+	$(CC) tests/source.c -o tests/source.out
+tests/jobs.out: tests/jobs.c tests/common.h
+	$(CC) tests/jobs.c -o tests/jobs.out
+tests/check.out: tests/check.c tests/common.h
+	$(CC) tests/check.c -o tests/check.out
+tests/blocks.out: tests/blocks.c tests/common.h
+	$(CC) tests/blocks.c -o tests/blocks.out
+tests/formats.out: tests/formats.c tests/common.h
+	$(CC) tests/formats.c -o tests/formats.out
+tests/snapshot.out: tests/snapshot.c tests/common.h
+	$(CC) tests/snapshot.c -o tests/snapshot.out
+tests/archive.out: tests/archive.c tests/common.h
+	$(CC) tests/archive.c -o tests/archive.out
+tests/demand.out: tests/demand.c tests/common.h
+	$(CC) tests/demand.c -o tests/demand.out
+tests/only.out: tests/only.c tests/common.h
+	$(CC) tests/only.c -o tests/only.out
+tests/pipeline.out: tests/pipeline.c tests/common.h
+	$(CC) tests/pipeline.c -o tests/pipeline.out
+tests/depfile.out: tests/depfile.c tests/common.h
+	$(CC) tests/depfile.c -o tests/depfile.out
+tests/serve.out: tests/serve.c tests/common.h
+	$(CC) tests/serve.c -o tests/serve.out
+tests/lines.out: tests/lines.c src/common/errors/errors.c src/common/errors/errors.h
+	$(CC) tests/lines.c -o tests/lines.out
+tests/files.out: tests/files.c tests/common.h
+	$(CC) tests/files.c -o tests/files.out
+tests/index.out: tests/index.c tests/common.h
+	$(CC) tests/index.c -o tests/index.out
+tests/embeds.out: tests/embeds.c tests/common.h
+	$(CC) tests/embeds.c -o tests/embeds.out
+
+DOCBINS=src/compilers/compiler-c/main src/compilers/compiler-m4/main src/backends/manpage/main
+DOCS=
+
+docs: $(DOCS)
+
+-include $(DOCS)
+
+.PHONY: all clean install check docs
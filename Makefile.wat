@@ -17,15 +17,17 @@
 
 CC=wcc386
 LD=wlink
-OBJS=src\compilers\compiler-c\main.obj src\compilers\compiler-c\embeds\structures.obj src\compilers\compiler-c\embeds\functions.obj src\compilers\compiler-c\embeds\macro_functions.obj src\compilers\compiler-c\embeds\constants.obj src\compilers\compiler-m4\main.obj src\compilers\compiler-m4\embeds\macro_functions.obj src\backends\manpage\main.obj src\common\errors\errors.obj src\common\parsing\parsing.obj src\extractors\extractor-c\main.obj src\extractors\extractor-m4\main.obj src\deps\cstring\cstring.obj src\deps\argparse\argparse.obj src\deps\argparse\extract.obj src\deps\argparse\ap_inter.obj 
-BINS=src\compilers\compiler-c\main.exe src\compilers\compiler-m4\main.exe src\backends\manpage\main.exe src\extractors\extractor-c\main.exe src\extractors\extractor-m4\main.exe 
-DEPS=src\compilers\compiler-c\embeds\structures.obj,src\compilers\compiler-c\embeds\functions.obj,src\compilers\compiler-c\embeds\macro_functions.obj,src\compilers\compiler-c\embeds\constants.obj,src\compilers\compiler-m4\embeds\macro_functions.obj,src\common\errors\errors.obj,src\common\parsing\parsing.obj,src\deps\cstring\cstring.obj,src\deps\argparse\argparse.obj,src\deps\argparse\extract.obj,src\deps\argparse\ap_inter.obj
+DOCFLAGS=--section 3
+OBJS=src\compilers\compiler-c\main.obj src\compilers\compiler-c\embeds\structures.obj src\compilers\compiler-c\embeds\functions.obj src\compilers\compiler-c\embeds\macro_functions.obj src\compilers\compiler-c\embeds\constants.obj src\compilers\compiler-c\embeds\requests.obj src\compilers\compiler-m4\main.obj src\compilers\compiler-m4\embeds\macro_functions.obj src\backends\manpage\main.obj src\common\errors\errors.obj src\common\parsing\parsing.obj src\common\intern\intern.obj src\common\index\index.obj src\extractors\extractor-c\main.obj src\extractors\extractor-m4\main.obj src\deps\cstring\cstring.obj src\deps\argparse\argparse.obj src\deps\argparse\extract.obj src\deps\argparse\ap_inter.obj src\tools\apropos\main.obj 
+BINS=src\compilers\compiler-c\main.exe src\compilers\compiler-m4\main.exe src\backends\manpage\main.exe src\extractors\extractor-c\main.exe src\extractors\extractor-m4\main.exe src\tools\apropos\main.exe 
+DEPS=src\compilers\compiler-c\embeds\structures.obj,src\compilers\compiler-c\embeds\functions.obj,src\compilers\compiler-c\embeds\macro_functions.obj,src\compilers\compiler-c\embeds\constants.obj,src\compilers\compiler-c\embeds\requests.obj,src\compilers\compiler-m4\embeds\macro_functions.obj,src\common\errors\errors.obj,src\common\parsing\parsing.obj,src\common\intern\intern.obj,src\common\index\index.obj,src\deps\cstring\cstring.obj,src\deps\argparse\argparse.obj,src\deps\argparse\extract.obj,src\deps\argparse\ap_inter.obj
 
 all: $(OBJS) $(BINS)
 
 clean: .SYMBOLIC
 	for %f in ($(OBJS)) do del %f
 	for %f in ($(BINS)) do del %f
+	for %f in ($(DOCS)) do del %f
 
 .SUFFIXES:
 
@@ -46,6 +48,8 @@ src\compilers\compiler-c\embeds\macro_functions.obj: src\compilers\compiler-c\em
 	$(CC) src\compilers\compiler-c\embeds\macro_functions.c -fo=src\compilers\compiler-c\embeds\macro_functions.obj
 src\compilers\compiler-c\embeds\constants.obj: src\compilers\compiler-c\embeds\constants.c 
 	$(CC) src\compilers\compiler-c\embeds\constants.c -fo=src\compilers\compiler-c\embeds\constants.obj
+src\compilers\compiler-c\embeds\requests.obj: src\compilers\compiler-c\embeds\requests.c 
+	$(CC) src\compilers\compiler-c\embeds\requests.c -fo=src\compilers\compiler-c\embeds\requests.obj
 src\compilers\compiler-m4\main.obj: src\compilers\compiler-m4\main.c 
 	$(CC) src\compilers\compiler-m4\main.c -fo=src\compilers\compiler-m4\main.obj
 src\compilers\compiler-m4\embeds\macro_functions.obj: src\compilers\compiler-m4\embeds\macro_functions.c 
@@ -56,6 +60,10 @@ src\common\errors\errors.obj: src\common\errors\errors.c
 	$(CC) src\common\errors\errors.c -fo=src\common\errors\errors.obj
 src\common\parsing\parsing.obj: src\common\parsing\parsing.c 
 	$(CC) src\common\parsing\parsing.c -fo=src\common\parsing\parsing.obj
+src\common\intern\intern.obj: src\common\intern\intern.c 
+	$(CC) src\common\intern\intern.c -fo=src\common\intern\intern.obj
+src\common\index\index.obj: src\common\index\index.c 
+	$(CC) src\common\index\index.c -fo=src\common\index\index.obj
 src\extractors\extractor-c\main.obj: src\extractors\extractor-c\main.c 
 	$(CC) src\extractors\extractor-c\main.c -fo=src\extractors\extractor-c\main.obj
 src\extractors\extractor-m4\main.obj: src\extractors\extractor-m4\main.c 
@@ -68,6 +76,8 @@ src\deps\argparse\extract.obj: src\deps\argparse\extract.c
 	$(CC) src\deps\argparse\extract.c -fo=src\deps\argparse\extract.obj
 src\deps\argparse\ap_inter.obj: src\deps\argparse\ap_inter.c 
 	$(CC) src\deps\argparse\ap_inter.c -fo=src\deps\argparse\ap_inter.obj
+src\tools\apropos\main.obj: src\tools\apropos\main.c 
+	$(CC) src\tools\apropos\main.c -fo=src\tools\apropos\main.obj
 
 src\extractors\extractor-c\main.exe: src\extractors\extractor-c\main.obj 
 	$(LD) FILE src\extractors\extractor-c\main.obj,$(DEPS) NAME src\extractors\extractor-c\main.exe
@@ -79,3 +89,10 @@ src\compilers\compiler-m4\main.exe: src\compilers\compiler-m4\main.obj
 	$(LD) FILE src\compilers\compiler-m4\main.obj,$(DEPS) NAME src\compilers\compiler-m4\main.exe
 src\backends\manpage\main.exe: src\backends\manpage\main.obj 
 	$(LD) FILE src\backends\manpage\main.obj,$(DEPS) NAME src\backends\manpage\main.exe
+src\tools\apropos\main.exe: src\tools\apropos\main.obj 
+	$(LD) FILE src\tools\apropos\main.obj,$(DEPS) NAME src\tools\apropos\main.exe
+
+DOCBINS=src\compilers\compiler-c\main.exe src\compilers\compiler-m4\main.exe src\backends\manpage\main.exe
+DOCS=
+
+docs: .SYMBOLIC $(DOCS)
@@ -0,0 +1,61 @@
+#!/bin/sh
+# Time the ways of running the C compiler on a large input, made from
+# many copies of a test input, and check that they all give the same
+# manuals. Each copy gets names of its own, so every copy has manuals
+# of its own. Run from the root of the repository, after building.
+#
+# $1: how many copies of the input to compile. defaults to 2000
+# $2: the input to copy. defaults to tests/inputs/point.h
+
+copies=${1:-2000}
+input=${2:-tests/inputs/point.h}
+work=tests/work/benchmark
+
+extractor=./src/extractors/extractor-c/main
+compiler=./src/compilers/compiler-c/main
+backend="./src/backends/manpage/main --section 3 --title Benchmark --date today"
+
+if [ ! -x $compiler ]; then
+    echo 'benchmark.sh: build the programs first'
+
+    exit 1
+fi
+
+rm -rf $work
+mkdir -p $work
+
+copy_index=0
+
+while [ $copy_index -lt $copies ]; do
+    sed -e "s/\(@name: .*\)$/\1_$copy_index/" -e "s/\(@embed: .*\)$/\1_$copy_index/" $input
+    copy_index=`expr $copy_index + 1`
+done > $work/input.h
+
+$extractor < $work/input.h > $work/input.ex
+
+# Run a command, and print how long it took in milliseconds. This
+# relies on the date command printing nanoseconds.
+#
+# $1: what is being timed
+# $2: the command to run
+timed() {
+    started=`date +%s%N`
+    sh -c "$2" || echo "benchmark.sh: '$1' failed"
+    finished=`date +%s%N`
+
+    printf '%-40s %8d ms\n' "$1" `expr \( $finished - $started \) / 1000000`
+}
+
+echo "`wc -l < $work/input.h` lines, `wc -l < $work/input.ex` tags"
+
+timed 'extract' "$extractor < $work/input.h > /dev/null"
+timed 'compile' "$compiler < $work/input.ex > $work/batch.out"
+timed 'compile --stream' "$compiler --stream < $work/input.ex > $work/stream.out"
+timed 'compile --pipeline' "$compiler --pipeline < $work/input.ex > $work/pipeline.out"
+timed 'compile --pipeline --source' "$compiler --pipeline --source $work/input.h > $work/source.out"
+timed 'extract | compile | backend' "$extractor < $work/input.h | $compiler | (mkdir -p $work/batch/doc && cd $work/batch && ../../../../$backend)"
+timed 'extract | compile --pipeline | backend' "$extractor < $work/input.h | $compiler --pipeline | (mkdir -p $work/pipeline/doc && cd $work/pipeline && ../../../../$backend)"
+
+cmp -s $work/stream.out $work/pipeline.out || echo 'benchmark.sh: --pipeline differs from --stream'
+cmp -s $work/stream.out $work/source.out || echo 'benchmark.sh: --pipeline --source differs from --stream'
+diff -r $work/batch $work/pipeline > /dev/null || echo 'benchmark.sh: the manuals differ'
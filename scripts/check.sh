@@ -15,8 +15,17 @@ if [ "`find tests/ -type f -name '*.out'`" = "" ]; then
     exit 1
 fi
 
+status=0
+
 for test_file in tests/*.out; do
     printf "Test '%s' starting.\n" $test_file
-    $1 ./$test_file
-    printf "Test '%s' completed.\n" $test_file
+
+    if $1 ./$test_file; then
+        printf "Test '%s' completed.\n" $test_file
+    else
+        printf "Test '%s' failed.\n" $test_file
+        status=1
+    fi
 done
+
+exit $status
@@ -5,4 +5,11 @@ if [ $# -eq 0 ]; then
 	exit
 fi
 
+# Hand the file to a running server (docgen-backend-manpage --serve SOCKET)
+# if DOCGEN_SOCKET points to one, rather than starting each program anew.
+if [ -n "$DOCGEN_SOCKET" ] && [ -S "$DOCGEN_SOCKET" ]; then
+	docgen-backend-manpage --client "$DOCGEN_SOCKET" --source "$1"
+	exit
+fi
+
 docgen-extractor-c < $1 | docgen-compiler | docgen-backend-manpage
@@ -42,66 +42,111 @@
  * units of documentation. The documentation is in turn composed of 'sections'
 */
 
+#define _POSIX_C_SOURCE 200112L
+
+/* The io_uring writer needs syscall, which is not part of POSIX */
+#ifdef DOCGEN_URING
+#define _DEFAULT_SOURCE 1
+#endif
+
 #include "../../docgen.h"
 
 #include "../../common/errors/errors.h"
+#include "../../common/intern/intern.h"
 #include "../../common/parsing/parsing.h"
+#include "../../common/index/index.h"
 
 #include "main.h"
 
-static const char *help_message =
-    "docgen-backend-manpage [ --section SECTION | -s SECTION ]\n"
-    "                       [ --title TITLE | -t TITLE ]\n"
-    "                       [ --date DATE | -d DATE ]\n"
-    "Generate manual pages from compiled input.\n"
-    "\n"
-    "Optional arguments:\n"
-    "   --section, -s SECTION       the section of the manual page. defaults to 1\n"
-    "   --title, -t TITLE           the title (top center text) of the manual page. defaults to \"Manual\"\n"
-    "   --date, -d DATE             the date the manual was last modified. defaults to an empty string\n"
-    "";
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <pthread.h>
+
+#include <sys/mman.h>
+
+#define WRITE_VECTORED 1
+#define WRITE_THREADED 1
+#define SNAPSHOT_MAPPED 1
+#define DOCGEN_SERVER 1
+
+/* Manuals can be written through an io_uring, if asked for when built */
+#if defined(__linux__) && defined(DOCGEN_URING)
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define WRITE_URING 1
+#endif
+
+/* The longest working directory a client can send */
+#define CLIENT_DIRECTORY_LENGTH 4096
+
+/* The most spans to give to a single writev call */
+#if defined(IOV_MAX) && IOV_MAX < 1024
+#define WRITE_VECTOR_LENGTH IOV_MAX
+#else
+#define WRITE_VECTOR_LENGTH 1024
+#endif
+#endif
+
+/* The help message, a line at a time, which keeps each string within
+ * the length C89 compilers have to support */
+static const char *help_message[] = {
+    "docgen-backend-manpage [ --section SECTION | -s SECTION ]\n",
+    "                       [ --title TITLE | -t TITLE ]\n",
+    "                       [ --date DATE | -d DATE ]\n",
+    "                       [ --stream | -S ]\n",
+    "                       [ --serve SOCKET | -L SOCKET ]\n",
+    "                       [ --client SOCKET | -C SOCKET ] [ --source FILE | -I FILE ]\n",
+    "                       [ --depfile FILE | -M FILE ] [ --formats FORMATS | -f FORMATS ]\n",
+    "                       [ --write-snapshot FILE | -W FILE ] [ --read-snapshot FILE | -R FILE ]\n",
+    "                       [ --index FILE | -X FILE ] [ --archive FILE | -A FILE ]\n",
+    "                       [ --embeds FILE | -e FILE ] [ --write-embeds FILE | -E FILE ]\n",
+    "                       [ --only NAMES | -o NAMES ]\n",
+    "Generate manual pages from compiled input.\n",
+    "\n",
+    "Optional arguments:\n",
+    "   --section, -s SECTION       the section of the manual page. defaults to 1\n",
+    "   --title, -t TITLE           the title (top center text) of the manual page. defaults to \"Manual\"\n",
+    "   --date, -d DATE             the date the manual was last modified. defaults to an empty string\n",
+    "   --stream, -S                write each manual as soon as the embeds it requests have been read\n",
+    "   --serve, -L SOCKET          keep running, and generate manual pages for jobs sent to a unix socket\n",
+    "   --client, -C SOCKET         send a job to a server, and list the manual pages it wrote\n",
+    "   --source, -I FILE           the source file of a job sent with --client, or of a dependency file\n",
+    "   --depfile, -M FILE          write a make rule for the manual pages written from the --source file\n",
+    "   --formats, -f FORMATS       the formats to write each manual in, separated by commas. the formats\n",
+    "                               are man, html (NAME.SECTION.html), and md (NAME.SECTION.md). defaults to man\n",
+    "   --write-snapshot, -W FILE   save the manuals built from the input, to write them again with --read-snapshot\n",
+    "   --read-snapshot, -R FILE    write the manuals saved in a snapshot, rather than ones built from the stdin\n",
+    "   --index, -X FILE            write an index of the manuals written, which docgen-apropos can search\n",
+    "   --archive, -A FILE          write the manuals into a tar archive rather than into doc/. a FILE of -\n",
+    "                               writes the archive to the stdout\n",
+    "   --embeds, -e FILE           look up embeds the input does not define in an embed database\n",
+    "   --write-embeds, -E FILE     save the embeds of the input, and of the --embeds database, into an embed\n",
+    "                               database, rather than writing manuals\n",
+    "   --only, -o NAMES            only write the manuals with these names, separated by commas. the\n",
+    "                               groups of other manuals are skipped rather than parsed\n",
+    NULL
+};
 
 /*
  * =====================
  * # Manual Formatters #
  * =====================
 */
-void translate_newlines(FILE *location, struct CString string) {
-    int character = 0;
-    int in_tsheet_table = 0;
-
-    for(character = 0; character < string.length; character++) {
-        /* We want to ignore the translation of lines between the troff table
-         * markers .TS, and .TE, since `.br`'s in between the table markers
-         * cause formatting to break. */
-        if(strncmp(string.contents + character, ".TS\n", strlen(".TS\n")) == 0) {
-            in_tsheet_table = 1;
-            character += 3;
-
-            fprintf(location, "%s", ".TS\n");
-
-            continue;
-        }
-
-        if(strncmp(string.contents + character, ".TE\n", strlen(".TE\n")) == 0) {
-            in_tsheet_table = 0;
-            character += 3;
-
-            fprintf(location, "%s", ".TE\n");
-
-            continue;
-        }
-
-        /*
-        if(string.contents[character] == '\n' && in_tsheet_table == 0) {
-            fprintf(location, "%s", "\n.br\n");*
-        } else {
-        }
-        */
-        fprintf(location, "%c", string.contents[character]);
-    }
-}
-
 void write_translated_lines(struct CString *location, struct CString string) {
     int index = 0;
     int length = string.length;
@@ -119,231 +164,299 @@ void write_translated_lines(struct CString *location, struct CString string) {
     }
 }
 
-int characters_until_linefeed(const char *input) {
-    int character_index = 0;
-    int calculated_length = 0;
-    int length = strlen(input);
+/* Add a span to a rope, unless it is empty */
+void add_span(struct CStringViews *rope, const char *contents, int length) {
+    struct CStringView span;
 
-    for(character_index = 0; character_index < length; character_index++) {
-        if(input[character_index] == '\n')
-           break;
+    if(length <= 0)
+        return;
 
-        calculated_length++;
-    }
+    span.contents = contents;
+    span.length = length;
 
-    return calculated_length;
+    carray_append(rope, span, CSTRING_VIEW);
 }
 
-void write_until_linefeed(const char *input, struct CString *output) {
-    int character_index = 0;
-    int length = strlen(input);
+void add_string(struct CStringViews *rope, const char *string) {
+    add_span(rope, string, (int) strlen(string));
+}
 
-    for(character_index = 0; character_index < length; character_index++) {
-        char character_nul_term[2] = {0x0, 0x0};
+/* Whether the next character written to a rope will start a line, which
+ * is when nothing was written yet, or the last span ends with a linefeed. */
+int starts_line(struct CStringViews *rope) {
+    struct CStringView last;
 
-        if(input[character_index] == '\n')
-           break;
+    if(carray_is_empty(rope) == 1)
+        return 1;
 
-        character_nul_term[0] = input[character_index];
+    last = rope->contents[rope->length - 1];
 
-        cstring_concats(output, character_nul_term);
-    }
+    return last.contents[last.length - 1] == '\n';
+}
+
+/* The amount of characters from a location in a span until the next linefeed,
+ * or the end of the span. */
+int characters_until_linefeed(struct CStringView input, int start) {
+    const char *linefeed = NULL;
+
+    if(start >= input.length)
+        return 0;
+
+    linefeed = memchr(input.contents + start, '\n', (size_t) (input.length - start));
+
+    if(linefeed == NULL)
+        return input.length - start;
+
+    return (int) (linefeed - (input.contents + start));
 }
 
-void translate_tsheet(struct CString input_string, struct CString *output_string) {
-    int in_bold_marker = 0;
-    int in_italics_marker = 0;
-    int in_table_marker = 0;
-    int in_list_marker = 0;
-    int in_right_shift_marker = 0;
+/* Add the text of a line of a manual from a location until the next
+ * linefeed, escaped for the format being written */
+void add_until_linefeed(struct ManualWriter *writer, struct CStringView input, int start) {
+    if(start >= input.length)
+        return;
+
+    writer->format->add_escaped(writer->output, input.contents + start, characters_until_linefeed(input, start));
+}
+
+/*
+ * Translate the TSHEET markers of a single span of a manual into the
+ * format being written. Text that is not part of a marker is not copied;
+ * it is added to the output as a span of the input, unless the format
+ * has to escape it, and the translations of markers are added as spans
+ * of the format's strings, or of the input.
+ *
+ * A marker never crosses the end of a span, since the spans of a body
+ * are either whole lines, or static fragments that contain no markers.
+*/
+void translate_tsheet_span(struct ManualWriter *writer, struct CStringView input) {
+    int run_start = 0;
     int character_index = 0;
+    struct TsheetState *state = &(writer->state);
+    const struct ManualFormat *format = writer->format;
+    struct CStringViews *output = writer->output;
 
-    for(character_index = 0; character_index < input_string.length; character_index++) {
-        char character = input_string.contents[character_index];
-        char character_nul_term[2] = {0x0, 0x0};
+    for(character_index = 0; character_index < input.length; character_index++) {
+        const char *marker = input.contents + character_index;
+        char next_character = 0;
 
         /* Interpret a TSHEET marker, but only if there is an extra character after */
-        if(character == '\\' && character_index + 1 < input_string.length) {
-            char next_character = input_string.contents[character_index + 1];
+        if(*marker != '\\' || character_index + 1 >= input.length)
+            continue;
 
-            /* Start or end italics */
-            if(next_character == 'I') {
-                INVERT_BOOLEAN(in_italics_marker);
+        format->add_escaped(output, input.contents + run_start, character_index - run_start);
+        next_character = marker[1];
+
+        /* Start or end italics */
+        if(next_character == 'I') {
+            INVERT_BOOLEAN(state->in_italics_marker);
  
-                if(in_italics_marker == 1) {
-                    cstring_concats(output_string, "\\fI"); 
-                } else if(in_italics_marker == 0) {
-                    cstring_concats(output_string, "\\fR"); 
-                } else {
-                    printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
-                    abort(); 
-                }
+            if(state->in_italics_marker == 1) {
+                add_string(output, format->italics_start); 
+            } else if(state->in_italics_marker == 0) {
+                add_string(output, format->italics_end); 
+            } else {
+                printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
+                abort(); 
             }
+        }
 
-            /* Start or end bold */
-            if(next_character == 'B') {
-                INVERT_BOOLEAN(in_bold_marker);
+        /* Start or end bold */
+        if(next_character == 'B') {
+            INVERT_BOOLEAN(state->in_bold_marker);
  
-                if(in_bold_marker == 1) {
-                    cstring_concats(output_string, "\\fB"); 
-                } else if(in_bold_marker == 0) {
-                    cstring_concats(output_string, "\\fR"); 
-                } else {
-                    printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
-                    abort(); 
-                }
+            if(state->in_bold_marker == 1) {
+                add_string(output, format->bold_start); 
+            } else if(state->in_bold_marker == 0) {
+                add_string(output, format->bold_end); 
+            } else {
+                printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
+                abort(); 
             }
+        }
 
-            /* Make an inline-section. */
-            if(next_character == 'M') {
-                cstring_concats(output_string, "\n"); 
-                cstring_concats(output_string, ".SH "); 
-                write_until_linefeed(input_string.contents + character_index + 1 + 1, output_string);
-                cstring_concats(output_string, "\n"); 
+        /* Make an inline-section. */
+        if(next_character == 'M') {
+            add_string(output, format->section_start); 
+            add_until_linefeed(writer, input, character_index + 1 + 1);
+            add_string(output, format->section_end); 
 
-                character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
-             }
+            character_index += characters_until_linefeed(input, character_index) - 1;
+         }
 
-            /* Force a new line (\n.br\n)*/
-            if(next_character == 'N')
-                cstring_concats(output_string, "\n.br"); 
+        /* Force a new line */
+        if(next_character == 'N')
+            add_string(output, format->line_break); 
 
-            /* Start or end a right-shift */
-            if(next_character == 'R') {
-                INVERT_BOOLEAN(in_right_shift_marker);
+        /* Start or end a right-shift */
+        if(next_character == 'R') {
+            INVERT_BOOLEAN(state->in_right_shift_marker);
  
-                if(in_right_shift_marker == 1) {
-                    cstring_concats(output_string, ".RS"); 
-                    write_until_linefeed(input_string.contents + character_index + 1 + 1, output_string);
-                    cstring_concats(output_string, "i\n"); 
-
-                    character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
-                } else if(in_right_shift_marker == 0) {
-                    cstring_concats(output_string, ".RE\n"); 
-                } else {
-                    printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
-                    abort(); 
+            if(state->in_right_shift_marker == 1) {
+                if(format->right_shift_start != NULL) {
+                    add_string(output, format->right_shift_start); 
+                    add_until_linefeed(writer, input, character_index + 1 + 1);
+                    add_string(output, format->right_shift_unit); 
                 }
+
+                character_index += characters_until_linefeed(input, character_index) - 1;
+            } else if(state->in_right_shift_marker == 0) {
+                add_string(output, format->right_shift_end); 
+            } else {
+                printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
+                abort(); 
             }
+        }
 
-            /* Escape a backslash */
-            if(next_character == '\\')
-                cstring_concats(output_string, "\\"); 
+        /* Escape a backslash */
+        if(next_character == '\\')
+            add_string(output, format->backslash); 
 
-            /* Display the separator and dump the rest of stuff. */
-            if(next_character == 'S') {
-                char separator_string[2] = {0x0, 0x0};
+        /* Set the separator of the table, and lay the table out. */
+        if(next_character == 'S') {
+            if(character_index + 1 + 1 + 1 < input.length)
+                state->table_separator = marker[1 + 1 + 1];
 
-                separator_string[0] = *(input_string.contents + character_index + 1 + 1 + 1);
+            if(format->table_layout_start != NULL) {
+                add_string(output, format->table_layout_start); 
 
-                cstring_concats(output_string, "tab("); 
-                cstring_concats(output_string, separator_string);
-                cstring_concats(output_string, ");\n"); 
-                cstring_concats(output_string, "l l l\n"); 
-                cstring_concats(output_string, "_ _ _\n"); 
-                cstring_concats(output_string, "l l l\n"); 
-                cstring_concats(output_string, ".\n"); 
+                if(character_index + 1 + 1 + 1 < input.length)
+                    add_span(output, marker + 1 + 1 + 1, 1);
 
-                character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
+                add_string(output, format->table_layout_end); 
             }
 
-            /* Dump an element */
-            if(next_character == 'E') {
-                write_until_linefeed(input_string.contents + character_index + 1 + 1 + 1, output_string);
-                cstring_concats(output_string, "\n"); 
+            character_index += characters_until_linefeed(input, character_index) - 1;
+        }
+
+        /* Dump an element */
+        if(next_character == 'E') {
+            struct CStringView row = {NULL, 0};
 
-                character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
+            if(character_index + 1 + 1 + 1 < input.length) {
+                row.contents = marker + 1 + 1 + 1;
+                row.length = characters_until_linefeed(input, character_index + 1 + 1 + 1);
             }
 
-            /* Start or end a table (line-based) */
-            if(strncmp(input_string.contents + character_index, "\\T\n", strlen("\\T\n")) == 0) {
-                INVERT_BOOLEAN(in_table_marker);
- 
-                if(in_table_marker == 1) {
-                    cstring_concats(output_string, ".TS\n"); 
-                } else if(in_table_marker == 0) {
-                    cstring_concats(output_string, ".TE\n"); 
-                } else {
-                    printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
-                    abort(); 
-                }
+            format->add_table_row(writer, row);
+
+            character_index += characters_until_linefeed(input, character_index) - 1;
+        }
 
-                character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
+        /* Start or end a table (line-based) */
+        if(next_character == 'T' && character_index + 2 < input.length && marker[2] == '\n') {
+            INVERT_BOOLEAN(state->in_table_marker);
+ 
+            if(state->in_table_marker == 1) {
+                add_string(output, format->table_start); 
+            } else if(state->in_table_marker == 0) {
+                add_string(output, format->table_end); 
+            } else {
+                printf("unhandled (%s:%i)\n", __FILE__, __LINE__);
+                abort(); 
             }
 
+            character_index += characters_until_linefeed(input, character_index) - 1;
+        }
 
-            /* Print a table header */
-            if(strncmp(input_string.contents + character_index, "\\H ", strlen("\\H ")) == 0) {
-                write_until_linefeed(input_string.contents + character_index + strlen("\\H "), output_string);
-                cstring_concats(output_string, "\n"); 
+        /* Print a table header */
+        if(next_character == 'H' && character_index + 2 < input.length && marker[2] == ' ') {
+            struct CStringView row = {NULL, 0};
 
-                character_index += characters_until_linefeed(input_string.contents + character_index) - 1;
+            if(character_index + (int) strlen("\\H ") < input.length) {
+                row.contents = marker + strlen("\\H ");
+                row.length = characters_until_linefeed(input, character_index + (int) strlen("\\H "));
             }
 
-            character_index++;
+            format->add_table_header(writer, row);
 
-            continue;
-        } 
+            character_index += characters_until_linefeed(input, character_index) - 1;
+        }
 
-        character_nul_term[0] = character;
-        cstring_concats(output_string, character_nul_term); 
+        character_index++;
+        run_start = character_index + 1;
     }
-}
 
-/*
- * =====================
- * # Argument handling #
- * =====================
-*/
-struct ProgramArguments parse_arguments(int argc, char **argv) {
-    struct ProgramArguments arguments = {"1", "Manual", ""};
-    struct ArgparseParser parser = argparse_init("docgen-backend-manapage", argc, argv);
+    format->add_escaped(output, input.contents + run_start, input.length - run_start);
+}
 
-    /* These are the options we want to accept */
-    argparse_add_option(&parser, "-s", "--section", 1);
-    argparse_add_option(&parser, "-t", "--title", 1);
-    argparse_add_option(&parser, "-d", "--date", 1);
+/* Translate a string of a manual, such as its name or an option */
+void translate_tsheet_string(struct ManualWriter *writer, const char *string) {
+    translate_tsheet_span(writer, common_parse_view_string(string));
+}
 
-    /* Display the help message */
-    if(argparse_option_exists(parser, "-h") != 0 || argparse_option_exists(parser, "--help") != 0) {
-        fprintf(LIBERROR_STREAM, "%s", help_message); 
+/* Translate the TSHEET markers of each span of a section's body */
+void translate_tsheet(struct ManualWriter *writer, struct CStringViews input) {
+    int span_index = 0;
 
-        exit(1);
+    for(span_index = 0; span_index < carray_length(&input); span_index++) {
+        translate_tsheet_span(writer, input.contents[span_index]);
     }
+}
 
-    argparse_error(parser);
+/*
+ * Write each span of a rope to a file. Where it is available, the spans
+ * are handed to writev in batches, so they are never copied into a single
+ * buffer before they are written.
+*/
+void write_spans(FILE *location, struct CStringViews spans) {
+#ifdef WRITE_VECTORED
+    int span_index = 0;
+    int descriptor = fileno(location);
+
+    while(span_index < carray_length(&spans)) {
+        int vector_index = 0;
+        ssize_t written = 0;
+        struct iovec vectors[WRITE_VECTOR_LENGTH];
+
+        for(vector_index = 0; vector_index < WRITE_VECTOR_LENGTH && span_index + vector_index < carray_length(&spans); vector_index++) {
+            vectors[vector_index].iov_base = (void *) spans.contents[span_index + vector_index].contents;
+            vectors[vector_index].iov_len = (size_t) spans.contents[span_index + vector_index].length;
+        }
 
-    /* Extract the options arguments (they already have assigned defaults) */
-    if(argparse_option_exists(parser, "-s") != 0)
-        arguments.section = argparse_get_option_parameter(parser, "-c", 0);
-    else if(argparse_option_exists(parser, "--section") != 0)
-        arguments.section = argparse_get_option_parameter(parser, "--section", 0);
+        written = writev(descriptor, vectors, vector_index);
 
-    if(argparse_option_exists(parser, "-t") != 0)
-        arguments.title = argparse_get_option_parameter(parser, "-t", 0);
-    else if(argparse_option_exists(parser, "--title") != 0)
-        arguments.title = argparse_get_option_parameter(parser, "--title", 0);
+        if(written < 0) {
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to write manual (%s)\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
 
-    if(argparse_option_exists(parser, "-d") != 0)
-        arguments.date = argparse_get_option_parameter(parser, "-d", 0);
-    else if(argparse_option_exists(parser, "--date") != 0)
-        arguments.date = argparse_get_option_parameter(parser, "--date", 0);
+        /* Skip the spans that were written entirely, and trim the
+         * one that was cut off, if any. */
+        while(span_index < carray_length(&spans) && written >= (ssize_t) spans.contents[span_index].length) {
+            written -= spans.contents[span_index].length;
+            span_index++;
+        }
 
-    argparse_free(parser);
+        if(written > 0) {
+            spans.contents[span_index].contents += written;
+            spans.contents[span_index].length -= (int) written;
+        }
+    }
+#else
+    int span_index = 0;
 
-    return arguments;
+    for(span_index = 0; span_index < carray_length(&spans); span_index++) {
+        fwrite(spans.contents[span_index].contents, 1, (size_t) spans.contents[span_index].length, location);
+    }
+#endif
 }
 
 /*
- * ======================
- * #  Main program junk #
- * ======================
+ * ===================
+ * # Manual Formats  #
+ * ===================
 */
+
 struct Section *find_section(struct Sections sections, const char *name) {
     int section_index = 0;
+    int name_id = common_intern_find(name);
+
+    if(name_id == COMMON_INTERN_MISSING)
+        return NULL;
 
     for(section_index = 0; section_index < carray_length(&sections); section_index++) {
-        if(strcmp(sections.contents[section_index].name.contents, name) != 0)
+        if(sections.contents[section_index].name != name_id)
            continue;
 
        return sections.contents + section_index; 
@@ -352,209 +465,2611 @@ struct Section *find_section(struct Sections sections, const char *name) {
     return NULL;
 }
 
-void add_section(struct Manual *location, struct Sections sections, const char *name) {
-    struct Section *named_section = find_section(sections, name);
+/* The sections a manual can have, in the order they are written, not
+ * counting SEE ALSO, which is made from the manual's references */
+static const char *manual_sections[] = {
+    "NAME", "SYNOPSIS", "DESCRIPTION", "RETURN VALUE", "NOTES", "EXAMPLES", NULL
+};
+
+/* Find a section of a manual to write, if it has one with any text */
+struct Section *displayed_section(struct Manual *manual, const char *name) {
+    struct Section *named_section = find_section(*manual->parts.sections, name);
 
     if(named_section == NULL)
-        return;
+        return NULL;
 
-    if(named_section->body.length == 0)
-        return;
+    if(common_parse_views_length(*named_section->body) == 0)
+        return NULL;
+
+    return named_section;
+}
 
-    cstring_concats(&(location->body), ".SH ");
-    cstring_concat(&(location->body), named_section->name);
-    cstring_concats(&(location->body), "\n");
+/* Add a row of a table, with the separator between the cells of the
+ * row placed between the cells the format writes for them */
+void add_table_cells(struct ManualWriter *writer, struct CStringView row, const char *cell_start, const char *cell_end) {
+    const char *cursor = row.contents;
+    const char *row_end = row.contents + row.length;
 
-    /* Only the example section really needs to have breaks explicitly made.
-     * (Or at least, this was our old plan). */
-    cstring_concat(&(location->body), named_section->body);
+    while(cursor != NULL && cursor <= row_end) {
+        const char *cell_finish = memchr(cursor, writer->state.table_separator, (size_t) (row_end - cursor));
 
-    /*
-    if(strcmp(name, "EXAMPLES") == 0) {
-        write_translated_lines(&(location->body), named_section->body);
-    } else {
-        cstring_concat(&(location->body), named_section->body);
+        if(cell_finish == NULL)
+            cell_finish = row_end;
+
+        add_string(writer->output, cell_start);
+        writer->format->add_escaped(writer->output, cursor, (int) (cell_finish - cursor));
+        add_string(writer->output, cell_end);
+
+        cursor = cell_finish == row_end ? NULL : cell_finish + 1;
     }
-    */
 }
 
-void add_embeds(struct Sections *sections, struct CString embed_string) {
-    struct Section *synopsis_section = find_section(*sections, "SYNOPSIS");
+/* Count the cells in a row of a table */
+int count_table_cells(struct ManualWriter *writer, struct CStringView row) {
+    int cells = 1;
+    const char *cursor = row.contents;
+    const char *row_end = row.contents + row.length;
 
-    if(synopsis_section == NULL)
-        return;
+    while(cursor < row_end && (cursor = memchr(cursor, writer->state.table_separator, (size_t) (row_end - cursor))) != NULL) {
+        cells++;
+        cursor++;
+    }
 
-    if(synopsis_section->body.length > 0)
-        cstring_concats(&(synopsis_section->body), "\n");
+    return cells;
+}
 
-    cstring_concat(&(synopsis_section->body), embed_string);
+/* Man pages. The text is written as it is, since TSHEET was made for
+ * roff, and the rows of a table are laid out by tbl, which underlines
+ * the header itself. */
+void add_man_table_row(struct ManualWriter *writer, struct CStringView row) {
+    add_span(writer->output, row.contents, row.length);
+    add_string(writer->output, "\n");
 }
 
-void add_section_see_also(struct Manual *location, struct References references) {
+void write_man_manual(struct ManualWriter *writer, struct Manual *manual, struct ProgramArguments arguments) {
     int section_index = 0;
+    int reference_index = 0;
+    struct References references = *manual->parts.references;
+
+    /* Manual needs a header */
+    add_string(writer->output, ".TH \"");
+    translate_tsheet_string(writer, manual->parts.name.contents);
+    add_string(writer->output, "\" \"");
+    translate_tsheet_string(writer, arguments.section);
+    add_string(writer->output, "\" \"");
+    translate_tsheet_string(writer, arguments.date);
+    add_string(writer->output, "\" \"");
+    add_string(writer->output, "\" \"");
+    translate_tsheet_string(writer, arguments.title);
+    add_string(writer->output, "\"\n");
+
+    for(section_index = 0; manual_sections[section_index] != NULL; section_index++) {
+        struct Section *section = displayed_section(manual, manual_sections[section_index]);
+
+        if(section == NULL)
+            continue;
+
+        add_string(writer->output, ".SH ");
+        translate_tsheet_string(writer, common_intern_string(section->name));
+        add_string(writer->output, "\n");
+        translate_tsheet(writer, *section->body);
+    }
 
     /* No references? Do not add this section. */
     if(carray_length(&references) == 0)
         return;
 
-    cstring_concats(&(location->body), ".SH SEE ALSO\n");
+    add_string(writer->output, ".SH SEE ALSO\n");
 
-    /* Add each section */
-    for(section_index = 0; section_index < carray_length(&references); section_index++) {
-        cstring_concat(&(location->body), references.contents[section_index].name);
-        cstring_concats(&(location->body), "(");
-        cstring_concat(&(location->body), references.contents[section_index].category);
-        cstring_concats(&(location->body), ")");
+    for(reference_index = 0; reference_index < carray_length(&references); reference_index++) {
+        translate_tsheet_string(writer, common_intern_string(references.contents[reference_index].name));
+        add_string(writer->output, "(");
+        translate_tsheet_string(writer, common_intern_string(references.contents[reference_index].category));
+        add_string(writer->output, ")");
 
         /* Do not add a comma unless there are still references to add */
-        if(section_index == (carray_length(&references) - 1))
+        if(reference_index == (carray_length(&references) - 1))
             continue; 
 
-        cstring_concats(&(location->body), ", ");
+        add_string(writer->output, ", ");
     }
 }
 
-struct Manuals *build_manuals(struct CStrings input_lines, struct ProgramArguments arguments) {
-    int line_index = 0;
-    struct Embeds *embeds = NULL;
-    struct Manuals *manuals = NULL;
+/* HTML pages. Each section is a heading and a block of text, and each
+ * reference is a link to the page of the manual it refers to. The spaces
+ * a line starts with are written as non-breaking spaces, which HTML does
+ * not collapse, so lines keep their indentation like they do in roff. */
+void add_html_escaped(struct CStringViews *output, const char *contents, int length) {
+    int run_start = 0;
+    int at_line_start = starts_line(output);
+    int character_index = 0;
 
-    embeds = carray_init(embeds, EMBED);
-    manuals = carray_init(manuals, MANUAL);
+    for(character_index = 0; character_index < length; character_index++) {
+        const char *escape = NULL;
+        char character = contents[character_index];
+
+        if(character == ' ' && at_line_start == 1)
+            escape = "&nbsp;";
+        else if(character == '&')
+            escape = "&amp;";
+        else if(character == '<')
+            escape = "&lt;";
+        else if(character == '>')
+            escape = "&gt;";
+        else if(character == '"')
+            escape = "&quot;";
+
+        at_line_start = character == '\n' || (character == ' ' && at_line_start == 1);
+
+        if(escape == NULL)
+            continue;
 
-    common_parse_embeds(input_lines, embeds);
+        add_span(output, contents + run_start, character_index - run_start);
+        add_string(output, escape);
+        run_start = character_index + 1;
+    }
 
-    /* Generate a manual for each START_GROUP found */
-    for(line_index = 0; line_index < carray_length(&input_lines); line_index++) {
-        int section_index = 0;
-        struct Manual new_manual;
-        struct CString manual_embeds;
-        struct Sections *sections = NULL;
-        struct References *references = NULL;
-        struct EmbedRequests *requests = NULL;
-        struct CString line = input_lines.contents[line_index];
+    add_span(output, contents + run_start, length - run_start);
+}
 
-        LIBERROR_INIT(new_manual);
+void add_html_table_header(struct ManualWriter *writer, struct CStringView row) {
+    add_string(writer->output, "<tr>");
+    add_table_cells(writer, row, "<th>", "</th>");
+    add_string(writer->output, "</tr>\n");
+}
 
-        if(strncmp(line.contents, "START_GROUP", strlen("START_GROUP")) != 0)
+void add_html_table_row(struct ManualWriter *writer, struct CStringView row) {
+    add_string(writer->output, "<tr>");
+    add_table_cells(writer, row, "<td>", "</td>");
+    add_string(writer->output, "</tr>\n");
+}
+
+void write_html_manual(struct ManualWriter *writer, struct Manual *manual, struct ProgramArguments arguments) {
+    int section_index = 0;
+    int reference_index = 0;
+    struct References references = *manual->parts.references;
+
+    add_string(writer->output, "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>");
+    translate_tsheet_string(writer, manual->parts.name.contents);
+    add_string(writer->output, "(");
+    translate_tsheet_string(writer, arguments.section);
+    add_string(writer->output, ")</title>\n</head>\n<body>\n<h1>");
+    translate_tsheet_string(writer, manual->parts.name.contents);
+    add_string(writer->output, "(");
+    translate_tsheet_string(writer, arguments.section);
+    add_string(writer->output, ")</h1>\n");
+
+    if(arguments.title[0] != '\0') {
+        add_string(writer->output, "<p>");
+        translate_tsheet_string(writer, arguments.title);
+        add_string(writer->output, "</p>\n");
+    }
+
+    for(section_index = 0; manual_sections[section_index] != NULL; section_index++) {
+        struct Section *section = displayed_section(manual, manual_sections[section_index]);
+
+        if(section == NULL)
             continue;
 
-        sections = carray_init(sections, SECTION);
-        requests = carray_init(requests, EMBED_REQUEST);
-        references = carray_init(references, REFERENCE);
-        new_manual.body = cstring_init("");
-        new_manual.name = cstring_init("");
-        manual_embeds = cstring_init("");
-
-        /* Get the name of the manual (which is right after the START_GROUP directive */
-        cstring_concats(&(new_manual.name), strchr(line.contents, ' ') + 1);
-
-        /* Retrieve this group's sections and metadata */
-        common_parse_prepends(input_lines, sections, line_index);
-        common_parse_sections(input_lines, sections, line_index);
-        common_parse_appends(input_lines, sections, line_index);
-        common_parse_embed_requests(input_lines, requests, line_index);
-        common_parse_references(input_lines, references, line_index);
-
-        /* Add the synopsis section, because if the synopsis ONLY has embeds in it, then
-         * it will not display because no APPEND, PREPEND, or START_SECTION directive
-         * appears in the compiled input. */
-        if(find_section(*sections, "SYNOPSIS") == NULL) {
-            struct Section new_section;
-
-            new_section.name = cstring_init("SYNOPSIS");
-            new_section.body = cstring_init("");
-
-            carray_append(sections, new_section, SECTION); 
-        }
-
-        /* Generate the synopsis' embed string */
-        common_parse_format_embeds(*embeds, *requests, &manual_embeds);
-
-        /* Add an extra line between existing synopsis text, and the embeds, if there is
-         * existing text. */
-        add_embeds(sections, manual_embeds);
-
-        /* Manual needs a header */
-        cstring_concats(&(new_manual.body), ".TH \"");
-        cstring_concat(&(new_manual.body), new_manual.name);
-        cstring_concats(&(new_manual.body), "\" \"");
-        cstring_concats(&(new_manual.body), arguments.section);
-        cstring_concats(&(new_manual.body), "\" \"");
-        cstring_concats(&(new_manual.body), arguments.date);
-        cstring_concats(&(new_manual.body), "\" \"");
-        cstring_concats(&(new_manual.body), "\" \"");
-        cstring_concats(&(new_manual.body), arguments.title);
-        cstring_concats(&(new_manual.body), "\"\n");
-
-        /* Add the synopsis section to the array of sections, unless it already exists. */
-
-        /* Add the sections to the manual string */
-        add_section(&new_manual, *sections, "NAME");
-        add_section(&new_manual, *sections, "SYNOPSIS");
-        add_section(&new_manual, *sections, "DESCRIPTION");
-        add_section(&new_manual, *sections, "RETURN VALUE");
-        add_section(&new_manual, *sections, "NOTES");
-        add_section(&new_manual, *sections, "EXAMPLES");
-
-        /* SEE ALSO is something we need to construct manually */
-        add_section_see_also(&new_manual, *references);
+        add_string(writer->output, "<h2>");
+        translate_tsheet_string(writer, common_intern_string(section->name));
+        add_string(writer->output, "</h2>\n<div>\n");
+        translate_tsheet(writer, *section->body);
+        add_string(writer->output, "</div>\n");
+    }
 
-        /* Add the final manual */
-        carray_append(manuals, new_manual, MANUAL);
+    if(carray_length(&references) > 0) {
+        add_string(writer->output, "<h2>SEE ALSO</h2>\n<div>\n");
+
+        for(reference_index = 0; reference_index < carray_length(&references); reference_index++) {
+            const char *name = common_intern_string(references.contents[reference_index].name);
+            const char *category = common_intern_string(references.contents[reference_index].category);
+
+            add_string(writer->output, "<a href=\"");
+            add_html_escaped(writer->output, name, (int) strlen(name));
+            add_string(writer->output, ".");
+            add_html_escaped(writer->output, category, (int) strlen(category));
+            add_string(writer->output, writer->format->extension);
+            add_string(writer->output, "\">");
+            add_html_escaped(writer->output, name, (int) strlen(name));
+            add_string(writer->output, "(");
+            add_html_escaped(writer->output, category, (int) strlen(category));
+            add_string(writer->output, ")</a>");
+
+            if(reference_index < carray_length(&references) - 1)
+                add_string(writer->output, ", ");
+        }
 
-        carray_free(sections, SECTION);
-        carray_free(requests, EMBED_REQUEST);
-        carray_free(references, REFERENCE);
-        cstring_free(manual_embeds);
+        add_string(writer->output, "\n</div>\n");
     }
 
-    carray_free(embeds, EMBED);
+    if(arguments.date[0] != '\0') {
+        add_string(writer->output, "<p>");
+        translate_tsheet_string(writer, arguments.date);
+        add_string(writer->output, "</p>\n");
+    }
 
-    return manuals;
+    add_string(writer->output, "</body>\n</html>\n");
 }
 
-int main(int argc, char **argv) {
-    int manual_index = 0;
-    struct Manuals *manuals = NULL;
-    struct CStrings *input_lines = NULL;
-    struct CString manual_path = cstring_init("");
-    struct CString tsheet_buffer = cstring_init("");
-    struct ProgramArguments arguments = parse_arguments(argc, argv);
+/* Markdown pages. Characters Markdown would take as formatting are
+ * escaped, tables are pipe tables, and lines keep their indentation the
+ * same way they do in HTML pages. Bold and italics are inline HTML, since
+ * Markdown's own delimiters do not open before a space, or close after
+ * one, and run into each other and into escaped characters, all of
+ * which happen where TSHEET markers are placed. */
+void add_markdown_escaped(struct CStringViews *output, const char *contents, int length) {
+    int run_start = 0;
+    int at_line_start = starts_line(output);
+    int character_index = 0;
 
-    input_lines = carray_init(input_lines, CSTRING);
-    common_parse_readlines(input_lines, stdin);
-    manuals = build_manuals(*input_lines, arguments);
+    for(character_index = 0; character_index < length; character_index++) {
+        char character = contents[character_index];
+        int leading_space = character == ' ' && at_line_start == 1;
 
-    /* Write each manual to its intended location */
-    for(manual_index = 0; manual_index < carray_length(manuals); manual_index++) {
-        FILE *manual_file = NULL;
-        struct Manual manual = manuals->contents[manual_index];
+        at_line_start = character == '\n' || leading_space == 1;
+
+        if(leading_space == 1) {
+            add_span(output, contents + run_start, character_index - run_start);
+            add_string(output, "&nbsp;");
+            run_start = character_index + 1;
+
+            continue;
+        }
+
+        if(strchr("\\`*_[]<>#|&", character) == NULL || character == '\0')
+            continue;
+
+        add_span(output, contents + run_start, character_index - run_start);
+        add_string(output, "\\");
+        run_start = character_index;
+    }
 
-        cstring_reset(&manual_path);
-        cstring_reset(&tsheet_buffer);
+    add_span(output, contents + run_start, length - run_start);
+}
 
-        /* Ceate the path for the manual */
-        cstring_concats(&manual_path, "doc/");
-        cstring_concat(&manual_path, manual.name);
-        cstring_concats(&manual_path, ".");
-        cstring_concats(&manual_path, arguments.section);
+void add_markdown_table_row(struct ManualWriter *writer, struct CStringView row) {
+    add_string(writer->output, "|");
+    add_table_cells(writer, row, " ", " |");
+    add_string(writer->output, "\n");
+}
 
-        manual_file = fopen(manual_path.contents, "w+");
-        LIBERROR_FILE_OPEN_FAILURE(manual_file, manual_path.contents);
+/* The header of a pipe table is underlined with a row of dashes */
+void add_markdown_table_header(struct ManualWriter *writer, struct CStringView row) {
+    int cell_index = 0;
 
-        /* Translate TSHEET markers, and write the manual, converting each
-         * linefeed into `\n.br\n`. */
-        translate_tsheet(manual.body, &tsheet_buffer);
-        translate_newlines(manual_file, tsheet_buffer);
+    add_markdown_table_row(writer, row);
+    add_string(writer->output, "|");
 
-        fclose(manual_file);
+    for(cell_index = count_table_cells(writer, row); cell_index > 0; cell_index--) {
+        add_string(writer->output, " --- |");
     }
 
-    carray_free(input_lines, CSTRING);
-    carray_free(manuals, MANUAL);
-    cstring_free(manual_path);
-    cstring_free(tsheet_buffer);
+    add_string(writer->output, "\n");
+}
+
+void write_markdown_manual(struct ManualWriter *writer, struct Manual *manual, struct ProgramArguments arguments) {
+    int section_index = 0;
+    int reference_index = 0;
+    struct References references = *manual->parts.references;
+
+    add_string(writer->output, "# ");
+    translate_tsheet_string(writer, manual->parts.name.contents);
+    add_string(writer->output, "(");
+    translate_tsheet_string(writer, arguments.section);
+    add_string(writer->output, ")\n\n");
+
+    if(arguments.title[0] != '\0') {
+        translate_tsheet_string(writer, arguments.title);
+        add_string(writer->output, "\n\n");
+    }
+
+    for(section_index = 0; manual_sections[section_index] != NULL; section_index++) {
+        struct Section *section = displayed_section(manual, manual_sections[section_index]);
+
+        if(section == NULL)
+            continue;
+
+        add_string(writer->output, "## ");
+        translate_tsheet_string(writer, common_intern_string(section->name));
+        add_string(writer->output, "\n\n");
+        translate_tsheet(writer, *section->body);
+        add_string(writer->output, "\n\n");
+    }
+
+    if(carray_length(&references) > 0) {
+        add_string(writer->output, "## SEE ALSO\n\n");
+
+        for(reference_index = 0; reference_index < carray_length(&references); reference_index++) {
+            const char *name = common_intern_string(references.contents[reference_index].name);
+            const char *category = common_intern_string(references.contents[reference_index].category);
+
+            add_string(writer->output, "[");
+            add_markdown_escaped(writer->output, name, (int) strlen(name));
+            add_string(writer->output, "(");
+            add_markdown_escaped(writer->output, category, (int) strlen(category));
+            add_string(writer->output, ")](");
+            add_string(writer->output, name);
+            add_string(writer->output, ".");
+            add_string(writer->output, category);
+            add_string(writer->output, writer->format->extension);
+            add_string(writer->output, ")");
+
+            if(reference_index < carray_length(&references) - 1)
+                add_string(writer->output, ", ");
+        }
+
+        add_string(writer->output, "\n\n");
+    }
+
+    if(arguments.date[0] != '\0') {
+        translate_tsheet_string(writer, arguments.date);
+        add_string(writer->output, "\n");
+    }
+}
+
+/* Every format manuals can be written in */
+const struct ManualFormat manual_formats[MANUAL_FORMAT_COUNT] = {
+    {"man", "", write_man_manual, add_span, add_man_table_row, add_man_table_row,
+     "\\fI", "\\fR", "\\fB", "\\fR", "\n.SH ", "\n", "\n.br", ".RS", "i\n", ".RE\n", "\\",
+     ".TS\n", ".TE\n", "tab(", ");\nl l l\n_ _ _\nl l l\n.\n"},
+    {"html", ".html", write_html_manual, add_html_escaped, add_html_table_header, add_html_table_row,
+     "<i>", "</i>", "<b>", "</b>", "\n<h2>", "</h2>\n", "<br>", "<div style=\"margin-left: ", "in\">\n", "</div>\n", "\\",
+     "<table>\n", "</table>\n", NULL, NULL},
+    {"md", ".md", write_markdown_manual, add_markdown_escaped, add_markdown_table_header, add_markdown_table_row,
+     "<i>", "</i>", "<b>", "</b>", "\n## ", "\n", "  ", NULL, NULL, "", "\\\\",
+     "\n", "\n", NULL, NULL}
+};
+
+/*
+ * Find the formats in a comma-separated list of their names. A format
+ * named more than once is only written once. Returns 0 if a name is not
+ * the name of a format.
+*/
+int parse_formats(struct ProgramArguments *arguments, const char *names) {
+    const char *cursor = names;
+
+    arguments->format_names = names;
+    arguments->format_count = 0;
+
+    while(*cursor != '\0') {
+        int format_index = 0;
+        int listed_index = 0;
+        size_t length = strcspn(cursor, ",");
+
+        for(format_index = 0; format_index < MANUAL_FORMAT_COUNT; format_index++) {
+            if(strlen(manual_formats[format_index].name) == length && strncmp(manual_formats[format_index].name, cursor, length) == 0)
+                break;
+        }
+
+        if(format_index == MANUAL_FORMAT_COUNT)
+            return 0;
+
+        for(listed_index = 0; listed_index < arguments->format_count; listed_index++) {
+            if(arguments->formats[listed_index] == manual_formats + format_index)
+                break;
+        }
+
+        if(listed_index == arguments->format_count) {
+            arguments->formats[arguments->format_count] = manual_formats + format_index;
+            arguments->format_count++;
+        }
+
+        cursor += length;
+
+        if(*cursor == ',')
+            cursor++;
+    }
+
+    return arguments->format_count > 0;
+}
+
+/*
+ * =====================
+ * # Argument handling #
+ * =====================
+*/
+struct ProgramArguments parse_arguments(int argc, char **argv) {
+    struct ProgramArguments arguments = {"1", "Manual", "", 0, NULL, NULL, NULL, NULL, "man", 0, {NULL}, NULL, NULL, NULL, NULL, NULL, NULL, 0,
+                                         NULL, NULL, NULL, NULL};
+    struct ArgparseParser parser = argparse_init("docgen-backend-manapage", argc, argv);
+
+    /* These are the options we want to accept */
+    argparse_add_option(&parser, "-s", "--section", 1);
+    argparse_add_option(&parser, "-t", "--title", 1);
+    argparse_add_option(&parser, "-d", "--date", 1);
+    argparse_add_option(&parser, "-S", "--stream", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-L", "--serve", 1);
+    argparse_add_option(&parser, "-C", "--client", 1);
+    argparse_add_option(&parser, "-I", "--source", 1);
+    argparse_add_option(&parser, "-M", "--depfile", 1);
+    argparse_add_option(&parser, "-f", "--formats", 1);
+    argparse_add_option(&parser, "-W", "--write-snapshot", 1);
+    argparse_add_option(&parser, "-R", "--read-snapshot", 1);
+    argparse_add_option(&parser, "-X", "--index", 1);
+    argparse_add_option(&parser, "-A", "--archive", 1);
+    argparse_add_option(&parser, "-e", "--embeds", 1);
+    argparse_add_option(&parser, "-E", "--write-embeds", 1);
+    argparse_add_option(&parser, "-o", "--only", 1);
+
+    /* Display the help message */
+    if(argparse_option_exists(parser, "-h") != 0 || argparse_option_exists(parser, "--help") != 0) {
+        int line_index = 0;
+
+        for(line_index = 0; help_message[line_index] != NULL; line_index++) {
+            fprintf(LIBERROR_STREAM, "%s", help_message[line_index]);
+        }
+
+        exit(1);
+    }
+
+    argparse_error(parser);
+
+    /* Extract the options arguments (they already have assigned defaults) */
+    if(argparse_option_exists(parser, "-s") != 0)
+        arguments.section = argparse_get_option_parameter(parser, "-c", 0);
+    else if(argparse_option_exists(parser, "--section") != 0)
+        arguments.section = argparse_get_option_parameter(parser, "--section", 0);
+
+    if(argparse_option_exists(parser, "-t") != 0)
+        arguments.title = argparse_get_option_parameter(parser, "-t", 0);
+    else if(argparse_option_exists(parser, "--title") != 0)
+        arguments.title = argparse_get_option_parameter(parser, "--title", 0);
+
+    if(argparse_option_exists(parser, "-d") != 0)
+        arguments.date = argparse_get_option_parameter(parser, "-d", 0);
+    else if(argparse_option_exists(parser, "--date") != 0)
+        arguments.date = argparse_get_option_parameter(parser, "--date", 0);
+
+    if(argparse_option_exists(parser, "-S") != 0 || argparse_option_exists(parser, "--stream") != 0)
+        arguments.stream = 1;
+
+    if(argparse_option_exists(parser, "-L") != 0)
+        arguments.serve = argparse_get_option_parameter(parser, "-L", 0);
+    else if(argparse_option_exists(parser, "--serve") != 0)
+        arguments.serve = argparse_get_option_parameter(parser, "--serve", 0);
+
+    if(argparse_option_exists(parser, "-C") != 0)
+        arguments.client = argparse_get_option_parameter(parser, "-C", 0);
+    else if(argparse_option_exists(parser, "--client") != 0)
+        arguments.client = argparse_get_option_parameter(parser, "--client", 0);
+
+    if(argparse_option_exists(parser, "-I") != 0)
+        arguments.source = argparse_get_option_parameter(parser, "-I", 0);
+    else if(argparse_option_exists(parser, "--source") != 0)
+        arguments.source = argparse_get_option_parameter(parser, "--source", 0);
+
+    if(argparse_option_exists(parser, "-M") != 0)
+        arguments.depfile = argparse_get_option_parameter(parser, "-M", 0);
+    else if(argparse_option_exists(parser, "--depfile") != 0)
+        arguments.depfile = argparse_get_option_parameter(parser, "--depfile", 0);
+
+    if(arguments.client != NULL && arguments.source == NULL) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --client needs a source file to be given with --source\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(argparse_option_exists(parser, "-f") != 0)
+        arguments.format_names = argparse_get_option_parameter(parser, "-f", 0);
+    else if(argparse_option_exists(parser, "--formats") != 0)
+        arguments.format_names = argparse_get_option_parameter(parser, "--formats", 0);
+
+    if(argparse_option_exists(parser, "-W") != 0)
+        arguments.write_snapshot = argparse_get_option_parameter(parser, "-W", 0);
+    else if(argparse_option_exists(parser, "--write-snapshot") != 0)
+        arguments.write_snapshot = argparse_get_option_parameter(parser, "--write-snapshot", 0);
+
+    if(argparse_option_exists(parser, "-R") != 0)
+        arguments.read_snapshot = argparse_get_option_parameter(parser, "-R", 0);
+    else if(argparse_option_exists(parser, "--read-snapshot") != 0)
+        arguments.read_snapshot = argparse_get_option_parameter(parser, "--read-snapshot", 0);
+
+    if(argparse_option_exists(parser, "-X") != 0)
+        arguments.index = argparse_get_option_parameter(parser, "-X", 0);
+    else if(argparse_option_exists(parser, "--index") != 0)
+        arguments.index = argparse_get_option_parameter(parser, "--index", 0);
+
+    if(arguments.index != NULL && (arguments.serve != NULL || arguments.client != NULL)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --index cannot be used with --serve or --client\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(argparse_option_exists(parser, "-A") != 0)
+        arguments.archive = argparse_get_option_parameter(parser, "-A", 0);
+    else if(argparse_option_exists(parser, "--archive") != 0)
+        arguments.archive = argparse_get_option_parameter(parser, "--archive", 0);
+
+    if(arguments.archive != NULL && (arguments.stream == 1 || arguments.serve != NULL || arguments.client != NULL)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --archive cannot be used with --stream, --serve, or --client\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every member of an archive is given the time it was made */
+    arguments.archive_modified = (unsigned long) time(NULL);
+
+    if(argparse_option_exists(parser, "-e") != 0)
+        arguments.embeds = argparse_get_option_parameter(parser, "-e", 0);
+    else if(argparse_option_exists(parser, "--embeds") != 0)
+        arguments.embeds = argparse_get_option_parameter(parser, "--embeds", 0);
+
+    if(argparse_option_exists(parser, "-E") != 0)
+        arguments.write_embeds = argparse_get_option_parameter(parser, "-E", 0);
+    else if(argparse_option_exists(parser, "--write-embeds") != 0)
+        arguments.write_embeds = argparse_get_option_parameter(parser, "--write-embeds", 0);
+
+    if(arguments.write_embeds != NULL && (arguments.stream == 1 || arguments.serve != NULL || arguments.client != NULL
+                                          || arguments.read_snapshot != NULL)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --write-embeds cannot be used with --stream, --serve, --client, or --read-snapshot\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    /* Only the database is written, so nothing these ask for would be */
+    if(arguments.write_embeds != NULL && (arguments.index != NULL || arguments.depfile != NULL
+                                          || arguments.write_snapshot != NULL || arguments.archive != NULL
+                                          || argparse_option_exists(parser, "-f") != 0
+                                          || argparse_option_exists(parser, "--formats") != 0)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --write-embeds cannot be used with --index, --depfile, --write-snapshot, --archive, or --formats\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(argparse_option_exists(parser, "-o") != 0)
+        arguments.only = argparse_get_option_parameter(parser, "-o", 0);
+    else if(argparse_option_exists(parser, "--only") != 0)
+        arguments.only = argparse_get_option_parameter(parser, "--only", 0);
+
+    if(arguments.only != NULL && (arguments.serve != NULL || arguments.client != NULL)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --only cannot be used with --serve or --client\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(arguments.stream == 1 && (arguments.write_snapshot != NULL || arguments.read_snapshot != NULL)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": snapshots cannot be used with --stream\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(parse_formats(&arguments, arguments.format_names) == 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": unknown format in '%s'. the formats are man, html, and md\n", arguments.format_names);
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(arguments.depfile != NULL && arguments.source == NULL) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --depfile needs a source file to be given with --source\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(arguments.depfile != NULL && arguments.serve != NULL) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --depfile cannot be used with --serve\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    argparse_free(parser);
+
+    return arguments;
+}
+
+/*
+ * ======================
+ * #  Main program junk #
+ * ======================
+*/
+
+void add_embeds(struct Sections *sections, struct Embeds embeds, const struct CommonEmbedDatabase *database,
+                struct EmbedRequests requests) {
+    struct Section *synopsis_section = find_section(*sections, "SYNOPSIS");
+
+    if(synopsis_section == NULL)
+        return;
+
+    if(common_parse_views_length(*synopsis_section->body) > 0) {
+        carray_append(synopsis_section->body, common_parse_view_string("\n"), CSTRING_VIEW);
+    }
+
+    common_parse_format_embeds(embeds, database, requests, synopsis_section->body);
+}
+
+/*
+ * Parse the group that starts at the START_GROUP directive on the given
+ * line into the parts of a manual. Everything a manual needs besides
+ * the embeds it requests is available at this point, and these parts
+ * are far smaller than the lines they were parsed from.
+*/
+struct PendingManual parse_manual(struct CommonParseInput input, int line_index) {
+    struct PendingManual pending;
+    struct CString line;
+
+    LIBERROR_INIT(pending);
+    VERIFY_CARRAY(input.lines);
+    LIBERROR_OUT_OF_BOUNDS(line_index, carray_length(input.lines));
+
+    line = input.lines->contents[line_index];
+
+    pending.sections = carray_init(pending.sections, SECTION);
+    pending.requests = carray_init(pending.requests, EMBED_REQUEST);
+    pending.references = carray_init(pending.references, REFERENCE);
+    pending.name = cstring_init("");
+    pending.input = input;
+    pending.owns_input = 0;
+
+    /* Get the name of the manual (which is right after the START_GROUP directive */
+    cstring_concats(&(pending.name), strchr(line.contents, ' ') + 1);
+
+    /* Retrieve this group's sections and metadata */
+    common_parse_prepends(input, pending.sections, line_index);
+    common_parse_sections(input, pending.sections, line_index);
+    common_parse_appends(input, pending.sections, line_index);
+    common_parse_embed_requests(input, pending.requests, line_index);
+    common_parse_references(input, pending.references, line_index);
+
+    return pending;
+}
+
+/* Release the parts of a manual. This cannot be a macro, since carray_free
+ * would need to expand inside of another carray_free. */
+void pending_manual_free(struct PendingManual pending) {
+    cstring_free(pending.name);
+    carray_free(pending.sections, SECTION);
+
+    if(pending.owns_input == 1)
+        common_parse_free_input(pending.input);
+
+    carray_free(pending.requests, EMBED_REQUEST);
+    carray_free(pending.references, REFERENCE);
+}
+
+void manual_free(struct Manual manual) {
+    pending_manual_free(manual.parts);
+}
+
+/*
+ * Make a manual out of its parts, using the embeds given to fill in the
+ * synopsis. The manual takes over the parts, and releases them with
+ * itself. Nothing about the format it will be written in is decided
+ * here, so the same manual can be written in any of them.
+*/
+struct Manual prepare_manual(struct PendingManual pending, struct Embeds embeds, const struct CommonEmbedDatabase *database) {
+    struct Manual new_manual;
+
+    LIBERROR_INIT(new_manual);
+
+    new_manual.parts = pending;
+
+    /* Add the synopsis section, because if the synopsis ONLY has embeds in it, then
+     * it will not display because no APPEND, PREPEND, or START_SECTION directive
+     * appears in the compiled input. */
+    if(find_section(*pending.sections, "SYNOPSIS") == NULL) {
+        struct Section new_section;
+
+        LIBERROR_INIT(new_section);
+        new_section.name = common_intern("SYNOPSIS");
+        new_section.body = carray_init(new_section.body, CSTRING_VIEW);
+
+        carray_append(new_manual.parts.sections, new_section, SECTION); 
+    }
+
+    /* Add the embeds to the synopsis, with an extra line between existing
+     * synopsis text, and the embeds, if there is existing text. */
+    add_embeds(new_manual.parts.sections, embeds, database, *pending.requests);
+
+    return new_manual;
+}
+
+/* Whether a manual is one of the names given to --only, separated by
+ * commas. Every manual is when there are none. */
+int manual_is_selected(const char *only, const char *name) {
+    const char *cursor = only;
+    size_t name_length = 0;
+
+    LIBERROR_IS_NULL(name);
+
+    if(only == NULL)
+        return 1;
+
+    name_length = strlen(name);
+
+    while(*cursor != '\0') {
+        size_t length = strcspn(cursor, ",");
+
+        if(length == name_length && strncmp(cursor, name, length) == 0)
+            return 1;
+
+        cursor += length;
+
+        if(*cursor == ',')
+            cursor++;
+    }
+
+    return 0;
+}
+
+/*
+ * Whether a group with the given name was already made into a manual,
+ * marking the name as made if not. Only the first group with a name is,
+ * whether the input is read all at once or streamed, since a streamed
+ * group may be written long after the groups that follow it.
+*/
+int manual_is_repeated(struct ManualNames *names, const char *name) {
+    int name_id = common_intern(name);
+
+    while(carray_length(names) <= name_id) {
+        carray_append(names, 0, MANUAL_NAME);
+    }
+
+    if(names->contents[name_id] == 1)
+        return 1;
+
+    names->contents[name_id] = 1;
+
+    return 0;
+}
+
+struct Manuals *build_manuals(struct CommonParseInput input, const struct CommonEmbedDatabase *database, const char *only) {
+    int line_index = 0;
+    struct Embeds *embeds = NULL;
+    struct Manuals *manuals = NULL;
+    struct ManualNames *names = NULL;
+
+    embeds = carray_init(embeds, EMBED);
+    manuals = carray_init(manuals, MANUAL);
+    names = carray_init(names, MANUAL_NAME);
+
+    common_parse_embeds(input, embeds);
+
+    /* Generate a manual for each START_GROUP found */
+    for(line_index = 0; line_index < carray_length(input.lines); line_index++) {
+        struct Manual new_manual;
+        struct CString line = input.lines->contents[line_index];
+
+        if(strncmp(line.contents, "START_GROUP", strlen("START_GROUP")) != 0)
+            continue;
+
+        /* Only groups that are written are worth parsing */
+        if(manual_is_selected(only, strchr(line.contents, ' ') + 1) == 0)
+            continue;
+
+        if(manual_is_repeated(names, strchr(line.contents, ' ') + 1) == 1)
+            continue;
+
+        new_manual = prepare_manual(parse_manual(input, line_index), *embeds, database);
+
+        /* Add the final manual */
+        carray_append(manuals, new_manual, MANUAL);
+    }
+
+    carray_free(embeds, EMBED);
+    carray_free(names, MANUAL_NAME);
+
+    return manuals;
+}
+
+/*
+ * ======================
+ * # Dependency files   #
+ * ======================
+*/
+
+/* Add a path to a make rule, escaping what make would treat specially */
+void add_make_path(struct CString *location, const char *path) {
+    for(; *path != '\0'; path++) {
+        char character[2] = {0x0, 0x0};
+
+        if(*path == ' ' || *path == '#')
+            cstring_concats(location, "\\");
+        else if(*path == '$')
+            cstring_concats(location, "$");
+
+        character[0] = *path;
+        cstring_concats(location, character);
+    }
+}
+
+/* Record a written manual as a target of the dependency file, if any.
+ * A manual written more than once is only recorded the first time. */
+void add_dependency_target(struct ProgramArguments arguments, const char *manual_path) {
+    char *found = NULL;
+    struct CString target = cstring_init(" ");
+
+    if(arguments.depfile_targets == NULL) {
+        cstring_free(target);
+
+        return;
+    }
+
+    add_make_path(&target, manual_path);
+
+    for(found = strstr(arguments.depfile_targets->contents, target.contents); found != NULL;
+        found = strstr(found + 1, target.contents)) {
+        if(found[target.length] == ' ' || found[target.length] == '\0')
+            break;
+    }
+
+    if(found == NULL)
+        cstring_concat(arguments.depfile_targets, target);
+
+    cstring_free(target);
+}
+
+/*
+ * Write the dependency file. Every manual that was written depends on
+ * the source file, and the dependency file depends on the source and
+ * on every manual, so removing a manual makes make run the rule that
+ * writes it again. It is only written once every manual is, so a run
+ * that fails part way through leaves no dependency file behind to look
+ * up to date.
+*/
+void write_dependencies(struct ProgramArguments arguments) {
+    FILE *depfile = NULL;
+    struct CString rule = cstring_init("");
+
+    add_make_path(&rule, arguments.depfile);
+    cstring_concats(&rule, ": ");
+    add_make_path(&rule, arguments.source);
+    cstring_concat(&rule, *arguments.depfile_targets);
+    cstring_concats(&rule, "\n");
+
+    if(arguments.depfile_targets->length != 0) {
+        cstring_concats(&rule, arguments.depfile_targets->contents + 1);
+        cstring_concats(&rule, ": ");
+        add_make_path(&rule, arguments.source);
+        cstring_concats(&rule, "\n");
+    }
+
+    depfile = fopen(arguments.depfile, "w");
+    LIBERROR_FILE_OPEN_FAILURE(depfile, arguments.depfile);
+
+    fwrite(rule.contents, 1, (size_t) rule.length, depfile);
+    fclose(depfile);
+
+    cstring_free(rule);
+}
+
+/*
+ * ======================
+ * #      Archives      #
+ * ======================
+*/
+
+/* Fill in a field of a tar header with a number in octal, which takes
+ * up all of the field but its last character */
+void set_archive_number(char *field, int field_length, unsigned long number) {
+    sprintf(field, "%0*lo", field_length - 1, number);
+}
+
+/* Add bytes that may include NULs to an archive */
+void add_archive_bytes(struct CString *archive, const char *bytes, int length) {
+    struct CStringView view;
+
+    view.contents = bytes;
+    view.length = length;
+
+    common_parse_concat_view(archive, view);
+}
+
+/*
+ * Add a file to a tar archive. Each file is a ustar header, followed by
+ * its contents, padded to a whole block. A path too long for the header
+ * is split into its prefix and name at a slash, as ustar allows.
+*/
+void add_archive_member(struct CString *archive, const char *path, struct CStringViews contents, unsigned long modified) {
+    int byte_index = 0;
+    int path_length = (int) strlen(path);
+    int name_start = 0;
+    unsigned long checksum = 0;
+    char header[ARCHIVE_BLOCK_LENGTH];
+    int content_length = common_parse_views_length(contents);
+
+    while(path_length - name_start > ARCHIVE_NAME_LENGTH) {
+        const char *slash = strchr(path + name_start, '/');
+
+        if(slash == NULL || slash - path > ARCHIVE_PREFIX_LENGTH) {
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": the path '%s' is too long to archive\n", path);
+            exit(EXIT_FAILURE);
+        }
+
+        name_start = (int) (slash - path) + 1;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header + ARCHIVE_NAME_OFFSET, path + name_start, (size_t) (path_length - name_start));
+    memcpy(header + ARCHIVE_PREFIX_OFFSET, path, (size_t) (name_start == 0 ? 0 : name_start - 1));
+    set_archive_number(header + ARCHIVE_MODE_OFFSET, 8, 0644);
+    set_archive_number(header + ARCHIVE_UID_OFFSET, 8, 0);
+    set_archive_number(header + ARCHIVE_GID_OFFSET, 8, 0);
+    set_archive_number(header + ARCHIVE_SIZE_OFFSET, 12, (unsigned long) content_length);
+    set_archive_number(header + ARCHIVE_MTIME_OFFSET, 12, modified);
+    header[ARCHIVE_TYPE_OFFSET] = '0';
+    memcpy(header + ARCHIVE_MAGIC_OFFSET, "ustar\0" "00", 8);
+
+    /* The checksum is taken with its own field as spaces */
+    memset(header + ARCHIVE_CHECKSUM_OFFSET, ' ', 8);
+
+    for(byte_index = 0; byte_index < ARCHIVE_BLOCK_LENGTH; byte_index++) {
+        checksum += (unsigned char) header[byte_index];
+    }
+
+    sprintf(header + ARCHIVE_CHECKSUM_OFFSET, "%06lo", checksum);
+
+    add_archive_bytes(archive, header, ARCHIVE_BLOCK_LENGTH);
+    common_parse_concat_views(archive, contents);
+
+    memset(header, 0, sizeof(header));
+    add_archive_bytes(archive, header, (ARCHIVE_BLOCK_LENGTH - content_length % ARCHIVE_BLOCK_LENGTH) % ARCHIVE_BLOCK_LENGTH);
+}
+
+/*
+ * Write the archive, which is the members each format job added in the
+ * order of the formats, and two empty blocks to end it. It is written
+ * all at once, once every manual is laid out.
+*/
+void write_archive(struct FormatJob *jobs, struct ProgramArguments arguments) {
+    int format_index = 0;
+    char end_blocks[ARCHIVE_BLOCK_LENGTH * 2];
+    FILE *archive_file = stdout;
+
+    if(strcmp(arguments.archive, "-") != 0) {
+        archive_file = fopen(arguments.archive, "wb");
+        LIBERROR_FILE_OPEN_FAILURE(archive_file, arguments.archive);
+    }
+
+    memset(end_blocks, 0, sizeof(end_blocks));
+
+    for(format_index = 0; format_index < arguments.format_count; format_index++) {
+        fwrite(jobs[format_index].archive.contents, 1, (size_t) jobs[format_index].archive.length, archive_file);
+    }
+
+    fwrite(end_blocks, 1, sizeof(end_blocks), archive_file);
+
+    if(fflush(archive_file) != 0 || ferror(archive_file) != 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to write the archive '%s'\n", arguments.archive);
+        exit(EXIT_FAILURE);
+    }
+
+    if(archive_file != stdout)
+        fclose(archive_file);
+}
+
+/*
+ * ======================
+ * #   Batched writes   #
+ * ======================
+*/
+
+#ifdef WRITE_URING
+/*
+ * Manuals can be written through an io_uring, rather than with an open,
+ * write, and close of their own. Each manual is queued as an open into
+ * a slot of the ring's file table, linked to a write from that slot and
+ * a close of it, and the queue is only submitted once it holds a batch
+ * of manuals, so the next manuals are laid out while the kernel writes
+ * the last ones. A manual's path and contents are copied into its slot,
+ * since the caller reuses its own buffers as soon as the manual is
+ * queued. A slot is free again once all three of its operations are
+ * complete.
+*/
+/* Unmap and close a ring, whether or not it was set up entirely */
+void uring_release(struct UringWriter *writer) {
+    int slot_index = 0;
+
+    if(writer->sqes != NULL && writer->sqes != MAP_FAILED)
+        munmap(writer->sqes, writer->sqes_length);
+
+    if(writer->cq_ring != NULL && writer->cq_ring != MAP_FAILED && writer->cq_ring != writer->sq_ring)
+        munmap(writer->cq_ring, writer->cq_ring_length);
+
+    if(writer->sq_ring != NULL && writer->sq_ring != MAP_FAILED)
+        munmap(writer->sq_ring, writer->sq_ring_length);
+
+    for(slot_index = 0; writer->ready == 1 && slot_index < URING_SLOTS; slot_index++) {
+        cstring_free(writer->slots[slot_index].path);
+        cstring_free(writer->slots[slot_index].contents);
+    }
+
+    close(writer->ring);
+    writer->ready = 0;
+}
+
+int uring_setup(struct UringWriter *writer) {
+    int slot_index = 0;
+    int registered[URING_SLOTS];
+    struct io_uring_params parameters;
+    unsigned char *sq_ring = NULL;
+    unsigned char *cq_ring = NULL;
+
+    memset(&parameters, 0, sizeof(parameters));
+    memset(writer, 0, sizeof(*writer));
+
+    writer->ring = (int) syscall(__NR_io_uring_setup, URING_ENTRIES, &parameters);
+
+    if(writer->ring < 0)
+        return 0;
+
+    /* Older kernels map the completion ring on its own */
+    writer->sq_ring_length = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+    writer->cq_ring_length = parameters.cq_off.cqes + parameters.cq_entries * sizeof(struct io_uring_cqe);
+
+    if((parameters.features & IORING_FEAT_SINGLE_MMAP) != 0 && writer->cq_ring_length > writer->sq_ring_length)
+        writer->sq_ring_length = writer->cq_ring_length;
+
+    writer->sq_ring = mmap(NULL, writer->sq_ring_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           writer->ring, IORING_OFF_SQ_RING);
+    writer->cq_ring = writer->sq_ring;
+
+    if(writer->sq_ring != MAP_FAILED && (parameters.features & IORING_FEAT_SINGLE_MMAP) == 0)
+        writer->cq_ring = mmap(NULL, writer->cq_ring_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               writer->ring, IORING_OFF_CQ_RING);
+
+    writer->sqes_length = parameters.sq_entries * sizeof(struct io_uring_sqe);
+    writer->sqes = mmap(NULL, writer->sqes_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        writer->ring, IORING_OFF_SQES);
+
+    /* Each slot starts out empty in the ring's file table */
+    for(slot_index = 0; slot_index < URING_SLOTS; slot_index++) {
+        registered[slot_index] = -1;
+    }
+
+    if(writer->sq_ring == MAP_FAILED || writer->cq_ring == MAP_FAILED || writer->sqes == MAP_FAILED
+       || syscall(__NR_io_uring_register, writer->ring, IORING_REGISTER_FILES, registered, URING_SLOTS) != 0) {
+        uring_release(writer);
+
+        return 0;
+    }
+
+    sq_ring = writer->sq_ring;
+    cq_ring = writer->cq_ring;
+    writer->sq_head = (unsigned *) (sq_ring + parameters.sq_off.head);
+    writer->sq_tail = (unsigned *) (sq_ring + parameters.sq_off.tail);
+    writer->sq_mask = (unsigned *) (sq_ring + parameters.sq_off.ring_mask);
+    writer->sq_array = (unsigned *) (sq_ring + parameters.sq_off.array);
+    writer->cq_head = (unsigned *) (cq_ring + parameters.cq_off.head);
+    writer->cq_tail = (unsigned *) (cq_ring + parameters.cq_off.tail);
+    writer->cq_mask = (unsigned *) (cq_ring + parameters.cq_off.ring_mask);
+    writer->cqes = (struct io_uring_cqe *) (cq_ring + parameters.cq_off.cqes);
+
+    for(slot_index = 0; slot_index < URING_SLOTS; slot_index++) {
+        writer->slots[slot_index].path = cstring_init("");
+        writer->slots[slot_index].contents = cstring_init("");
+    }
+
+    writer->ready = 1;
+
+    return 1;
+}
+
+/* Go through the operations that have completed, and free the slots
+ * whose manuals are written. Any failure ends the program. */
+void uring_reap(struct UringWriter *writer) {
+    unsigned head = *writer->cq_head;
+
+    while(head != __atomic_load_n(writer->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *completion = writer->cqes + (head & *writer->cq_mask);
+        struct UringSlot *slot = writer->slots + completion->user_data / URING_OPERATIONS;
+        int operation = (int) (completion->user_data % URING_OPERATIONS);
+
+        /* Operations linked after one that failed are cancelled, and
+         * the one that failed is reported on its own */
+        if(completion->res < 0 && completion->res != -ECANCELED) {
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to write manual '%s' (%s)\n", slot->path.contents,
+                    strerror(-completion->res));
+            exit(EXIT_FAILURE);
+        }
+
+        if(operation == URING_WRITE && completion->res >= 0 && completion->res != slot->contents.length) {
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to write manual '%s' (short write)\n", slot->path.contents);
+            exit(EXIT_FAILURE);
+        }
+
+        slot->completions--;
+        head++;
+    }
+
+    __atomic_store_n(writer->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/* Submit the operations queued so far, and wait for at least some
+ * number of operations to complete */
+void uring_submit(struct UringWriter *writer, unsigned wait) {
+    while(syscall(__NR_io_uring_enter, writer->ring, writer->queued, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0,
+                  NULL, 0) < 0) {
+        if(errno == EINTR)
+            continue;
+
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to submit manuals (%s)\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    writer->queued = 0;
+    uring_reap(writer);
+}
+
+/* Find a free slot, waiting on the ring if every slot is in use */
+int uring_find_slot(struct UringWriter *writer) {
+    while(1) {
+        int slot_index = 0;
+
+        for(slot_index = 0; slot_index < URING_SLOTS; slot_index++) {
+            if(writer->slots[slot_index].completions == 0)
+                return slot_index;
+        }
+
+        uring_submit(writer, 1);
+    }
+}
+
+/* Fill in the next entry of the submission queue. The tail is only
+ * moved once the whole chain is filled in. */
+struct io_uring_sqe *uring_queue(struct UringWriter *writer, unsigned tail, int opcode, int slot_index, int operation) {
+    unsigned entry_index = tail & *writer->sq_mask;
+    struct io_uring_sqe *entry = writer->sqes + entry_index;
+
+    memset(entry, 0, sizeof(*entry));
+    entry->opcode = (unsigned char) opcode;
+    entry->user_data = (unsigned long) (slot_index * URING_OPERATIONS + operation);
+    writer->sq_array[entry_index] = entry_index;
+
+    return entry;
+}
+
+/* Queue a manual to be written to a path */
+void uring_write_manual(struct UringWriter *writer, const char *path, struct CStringViews spans) {
+    int slot_index = uring_find_slot(writer);
+    unsigned tail = *writer->sq_tail;
+    struct UringSlot *slot = writer->slots + slot_index;
+    struct io_uring_sqe *entry = NULL;
+
+    cstring_reset(&slot->path);
+    cstring_concats(&slot->path, path);
+    cstring_reset(&slot->contents);
+    common_parse_concat_views(&slot->contents, spans);
+
+    entry = uring_queue(writer, tail++, IORING_OP_OPENAT, slot_index, URING_OPEN);
+    entry->fd = AT_FDCWD;
+    entry->addr = (unsigned long) slot->path.contents;
+    entry->len = 0666;
+    entry->open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+    entry->file_index = (unsigned) slot_index + 1;
+    entry->flags = IOSQE_IO_LINK;
+
+    entry = uring_queue(writer, tail++, IORING_OP_WRITE, slot_index, URING_WRITE);
+    entry->fd = slot_index;
+    entry->addr = (unsigned long) slot->contents.contents;
+    entry->len = (unsigned) slot->contents.length;
+    entry->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+
+    entry = uring_queue(writer, tail++, IORING_OP_CLOSE, slot_index, URING_CLOSE);
+    entry->file_index = (unsigned) slot_index + 1;
+
+    __atomic_store_n(writer->sq_tail, tail, __ATOMIC_RELEASE);
+    slot->completions = URING_OPERATIONS;
+    writer->queued += URING_OPERATIONS;
+
+    if(writer->queued >= URING_BATCH * URING_OPERATIONS)
+        uring_submit(writer, 0);
+}
+
+/* Wait for every manual queued to be written, and release the ring */
+void uring_finish(struct UringWriter *writer) {
+    int slot_index = 0;
+
+    for(slot_index = 0; slot_index < URING_SLOTS; slot_index++) {
+        while(writer->slots[slot_index].completions > 0) {
+            uring_submit(writer, 1);
+        }
+    }
+
+    uring_release(writer);
+}
+#endif
+
+/*
+ * Set up where manuals are written. They go into the archive, if one is
+ * given, and through an io_uring, if it was built in and the kernel has
+ * one to give. Otherwise, each manual is written to a file of its own.
+*/
+void open_manual_sink(struct ManualSink *sink, struct CString *archive) {
+    sink->archive = archive;
+    sink->uring = NULL;
+
+#ifdef WRITE_URING
+    if(archive != NULL)
+        return;
+
+    sink->uring = malloc(sizeof(*sink->uring));
+
+    if(uring_setup(sink->uring) == 1)
+        return;
+
+    free(sink->uring);
+    sink->uring = NULL;
+#endif
+}
+
+/* Wait for every manual given to a sink to be written, after which the
+ * sink writes each manual to a file of its own, like a sink of no kind. */
+void close_manual_sink(struct ManualSink *sink) {
+#ifdef WRITE_URING
+    if(sink->uring != NULL) {
+        uring_finish(sink->uring);
+        free(sink->uring);
+    }
+#endif
+
+    sink->archive = NULL;
+    sink->uring = NULL;
+}
+
+/* Find the path a manual is written to in a format */
+void find_manual_path(struct Manual *manual, const struct ManualFormat *format, struct ProgramArguments arguments,
+                      struct CString *manual_path) {
+    cstring_reset(manual_path);
+    cstring_concats(manual_path, "doc/");
+    cstring_concat(manual_path, manual->parts.name);
+    cstring_concats(manual_path, ".");
+    cstring_concats(manual_path, arguments.section);
+    cstring_concats(manual_path, format->extension);
+}
+
+/*
+ * Write a manual in a format to its intended location, or hand it to the
+ * sink given, if any. The path and buffer are given by the caller so they
+ * can be reused between manuals.
+*/
+void write_manual_format(struct Manual *manual, const struct ManualFormat *format, struct ProgramArguments arguments,
+                         struct CString *manual_path, struct CStringViews *spans, struct ManualSink *sink) {
+    FILE *manual_file = NULL;
+    struct ManualWriter writer;
+
+    LIBERROR_INIT(writer);
+    spans->length = 0;
+    writer.format = format;
+    writer.output = spans;
+    writer.state.table_separator = '\t';
+
+    find_manual_path(manual, format, arguments, manual_path);
+
+    /* Lay the manual out with its TSHEET markers translated, and write it */
+    format->write_manual(&writer, manual, arguments);
+
+    if(sink != NULL && sink->archive != NULL) {
+        add_archive_member(sink->archive, manual_path->contents, *spans, arguments.archive_modified);
+
+        return;
+    }
+
+#ifdef WRITE_URING
+    if(sink != NULL && sink->uring != NULL) {
+        uring_write_manual(sink->uring, manual_path->contents, *spans);
+
+        return;
+    }
+#endif
+
+    manual_file = fopen(manual_path->contents, "w+");
+    LIBERROR_FILE_OPEN_FAILURE(manual_file, manual_path->contents);
+
+    write_spans(manual_file, *spans);
+
+    fclose(manual_file);
+}
+
+/*
+ * Find the brief of a manual, which is what the first line of its NAME
+ * section says after the name of the manual. It is kept as plain text,
+ * so the TSHEET markers in it are left out.
+*/
+void find_manual_brief(struct Manual *manual, struct CString *brief) {
+    int span_index = 0;
+    int separator = 0;
+    int line_ended = 0;
+    struct CString text = cstring_init("");
+    struct Section *name_section = displayed_section(manual, "NAME");
+
+    cstring_reset(brief);
+
+    for(span_index = 0; name_section != NULL && line_ended == 0 && span_index < carray_length(name_section->body); span_index++) {
+        int character_index = 0;
+        struct CStringView span = name_section->body->contents[span_index];
+
+        for(character_index = 0; line_ended == 0 && character_index < span.length; character_index++) {
+            char character[2] = {0x0, 0x0};
+
+            character[0] = span.contents[character_index];
+
+            /* Leave out markers, but not escaped backslashes */
+            if(character[0] == '\\' && character_index + 1 < span.length) {
+                character_index++;
+
+                if(span.contents[character_index] != '\\')
+                    continue;
+            }
+
+            if(character[0] == '\n' && text.length > 0)
+                line_ended = 1;
+            else
+                cstring_concats(&text, character);
+        }
+    }
+
+    separator = cstring_finds(text, " - ");
+
+    if(separator == CSTRING_NOT_FOUND)
+        cstring_concats(brief, text.contents);
+    else
+        cstring_concats(brief, text.contents + separator + strlen(" - "));
+
+    cstring_free(text);
+}
+
+/* Record a written manual in the index, if any. Each manual is listed
+ * once, with the path of the first format it was written in. */
+void add_index_line(struct ProgramArguments arguments, struct Manual *manual, struct CString *manual_path) {
+    struct CString brief;
+
+    if(arguments.index_lines == NULL)
+        return;
+
+    brief = cstring_init("");
+    find_manual_path(manual, arguments.formats[0], arguments, manual_path);
+    find_manual_brief(manual, &brief);
+
+    common_index_add(arguments.index_lines, manual->parts.name.contents, arguments.section, manual_path->contents,
+                     brief.contents);
+
+    cstring_free(brief);
+}
+
+/* Write a manual in each of the formats asked for */
+void write_manual(struct Manual manual, struct ProgramArguments arguments, struct CString *manual_path, struct CStringViews *spans,
+                  struct ManualSink *sink) {
+    int format_index = 0;
+
+    for(format_index = 0; format_index < arguments.format_count; format_index++) {
+        write_manual_format(&manual, arguments.formats[format_index], arguments, manual_path, spans, sink);
+        add_dependency_target(arguments, manual_path->contents);
+    }
+
+    add_index_line(arguments, &manual, manual_path);
+}
+
+/* Write every manual in one format */
+void *write_format_job(void *argument) {
+    int manual_index = 0;
+    struct FormatJob *job = argument;
+    struct CString manual_path = cstring_init("");
+    struct CStringViews *spans = NULL;
+    struct ManualSink sink;
+
+    spans = carray_init(spans, CSTRING_VIEW);
+    open_manual_sink(&sink, job->arguments.archive == NULL ? NULL : &job->archive);
+
+    for(manual_index = 0; manual_index < carray_length(job->manuals); manual_index++) {
+        write_manual_format(job->manuals->contents + manual_index, job->format, job->arguments, &manual_path, spans, &sink);
+    }
+
+    close_manual_sink(&sink);
+    cstring_free(manual_path);
+    carray_free(spans, CSTRING_VIEW);
+
+    return NULL;
+}
+
+/*
+ * Write every manual in each of the formats asked for. The manuals are
+ * only read while they are written, so when there are several formats,
+ * each one is written on its own thread.
+*/
+void write_manuals(struct Manuals *manuals, struct ProgramArguments arguments) {
+    int format_index = 0;
+    int manual_index = 0;
+    struct CString manual_path = cstring_init("");
+    struct FormatJob jobs[MANUAL_FORMAT_COUNT];
+
+    for(format_index = 0; format_index < arguments.format_count; format_index++) {
+        jobs[format_index].manuals = manuals;
+        jobs[format_index].format = arguments.formats[format_index];
+        jobs[format_index].arguments = arguments;
+
+        if(arguments.archive != NULL)
+            jobs[format_index].archive = cstring_init("");
+    }
+
+#ifdef WRITE_THREADED
+    if(arguments.format_count > 1) {
+        pthread_t threads[MANUAL_FORMAT_COUNT];
+
+        for(format_index = 0; format_index < arguments.format_count; format_index++) {
+            if(pthread_create(threads + format_index, NULL, write_format_job, jobs + format_index) == 0)
+                continue;
+
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to start a thread for the %s format\n", jobs[format_index].format->name);
+            exit(EXIT_FAILURE);
+        }
+
+        for(format_index = 0; format_index < arguments.format_count; format_index++) {
+            pthread_join(threads[format_index], NULL);
+        }
+    } else {
+        write_format_job(jobs);
+    }
+#else
+    for(format_index = 0; format_index < arguments.format_count; format_index++) {
+        write_format_job(jobs + format_index);
+    }
+#endif
+
+    if(arguments.archive != NULL) {
+        write_archive(jobs, arguments);
+
+        for(format_index = 0; format_index < arguments.format_count; format_index++) {
+            cstring_free(jobs[format_index].archive);
+        }
+
+        if(strcmp(arguments.archive, "-") != 0)
+            add_dependency_target(arguments, arguments.archive);
+    }
+
+    /* Every file is known once they are all written */
+    for(manual_index = 0; arguments.depfile_targets != NULL && arguments.archive == NULL && manual_index < carray_length(manuals); manual_index++) {
+        for(format_index = 0; format_index < arguments.format_count; format_index++) {
+            find_manual_path(manuals->contents + manual_index, arguments.formats[format_index], arguments, &manual_path);
+            add_dependency_target(arguments, manual_path.contents);
+        }
+    }
+
+    for(manual_index = 0; arguments.index_lines != NULL && manual_index < carray_length(manuals); manual_index++) {
+        add_index_line(arguments, manuals->contents + manual_index, &manual_path);
+    }
+
+    cstring_free(manual_path);
+}
+
+/* Make a manual out of its parts, and write it out right away */
+void write_pending_manual(struct PendingManual pending, struct Embeds embeds, struct ProgramArguments arguments,
+                          struct CString *manual_path, struct CStringViews *spans, struct ManualSink *sink) {
+    struct Manual manual = prepare_manual(pending, embeds, arguments.embed_database);
+
+    write_manual(manual, arguments, manual_path, spans, sink);
+    MANUAL_FREE(manual);
+}
+
+/*
+ * ======================
+ * #     Snapshots      #
+ * ======================
+*/
+
+/*
+ * A snapshot is the manuals built from a compiled input, saved so they
+ * can be written again, with other options or in other formats, without
+ * parsing the input or merging its sections again. It is laid out as:
+ *
+ *   SNAPSHOT_MAGIC
+ *   the number of manuals
+ *   for each manual:
+ *     its name
+ *     the number of sections, and for each one:
+ *       its name
+ *       the number of spans in its body, and each span
+ *     the number of references, and for each one:
+ *       its name, and its category
+ *
+ * Numbers are ints, and strings are a length followed by that many
+ * characters and a NUL, so the spans of a loaded snapshot can point
+ * straight into the file. Numbers are stored in the byte order of the
+ * machine that wrote them, so a snapshot is not meant to be moved
+ * between machines.
+*/
+void write_snapshot_int(FILE *location, int value) {
+    fwrite(&value, sizeof(value), 1, location);
+}
+
+void write_snapshot_string(FILE *location, const char *contents, int length) {
+    write_snapshot_int(location, length);
+    fwrite(contents, 1, (size_t) length, location);
+    fputc('\0', location);
+}
+
+/* Save the manuals into a snapshot */
+void write_snapshot(struct Manuals *manuals, const char *path) {
+    int manual_index = 0;
+    FILE *snapshot_file = fopen(path, "wb");
+
+    LIBERROR_FILE_OPEN_FAILURE(snapshot_file, path);
+
+    fwrite(SNAPSHOT_MAGIC, 1, strlen(SNAPSHOT_MAGIC), snapshot_file);
+    write_snapshot_int(snapshot_file, carray_length(manuals));
+
+    for(manual_index = 0; manual_index < carray_length(manuals); manual_index++) {
+        int section_index = 0;
+        int reference_index = 0;
+        struct PendingManual parts = manuals->contents[manual_index].parts;
+
+        write_snapshot_string(snapshot_file, parts.name.contents, parts.name.length);
+        write_snapshot_int(snapshot_file, carray_length(parts.sections));
+
+        for(section_index = 0; section_index < carray_length(parts.sections); section_index++) {
+            int span_index = 0;
+            struct Section section = parts.sections->contents[section_index];
+
+            write_snapshot_string(snapshot_file, common_intern_string(section.name), common_intern_string_length(section.name));
+            write_snapshot_int(snapshot_file, carray_length(section.body));
+
+            for(span_index = 0; span_index < carray_length(section.body); span_index++) {
+                write_snapshot_string(snapshot_file, section.body->contents[span_index].contents, section.body->contents[span_index].length);
+            }
+        }
+
+        write_snapshot_int(snapshot_file, carray_length(parts.references));
+
+        for(reference_index = 0; reference_index < carray_length(parts.references); reference_index++) {
+            struct Reference reference = parts.references->contents[reference_index];
+
+            write_snapshot_string(snapshot_file, common_intern_string(reference.name), common_intern_string_length(reference.name));
+            write_snapshot_string(snapshot_file, common_intern_string(reference.category), common_intern_string_length(reference.category));
+        }
+    }
+
+    fclose(snapshot_file);
+}
+
+/* Read a number from a snapshot, exiting if the snapshot ends first */
+int read_snapshot_int(struct SnapshotReader *reader) {
+    int value = 0;
+
+    if((size_t) (reader->end - reader->cursor) < sizeof(value)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": snapshot '%s' is cut short\n", reader->path);
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(&value, reader->cursor, sizeof(value));
+    reader->cursor += sizeof(value);
+
+    return value;
+}
+
+/* Read a string from a snapshot. The string is not copied, so it points
+ * into the snapshot, and is NUL terminated. */
+struct CStringView read_snapshot_string(struct SnapshotReader *reader) {
+    struct CStringView string;
+
+    string.length = read_snapshot_int(reader);
+
+    if(string.length < 0 || reader->end - reader->cursor < (long) string.length + 1 || reader->cursor[string.length] != '\0') {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": snapshot '%s' is cut short\n", reader->path);
+        exit(EXIT_FAILURE);
+    }
+
+    string.contents = reader->cursor;
+    reader->cursor += string.length + 1;
+
+    return string;
+}
+
+/*
+ * Load a snapshot into memory. Where it is available, the snapshot is
+ * mapped rather than read, so loading it only costs the pages of it that
+ * are touched.
+*/
+struct Snapshot load_snapshot(const char *path) {
+    struct Snapshot snapshot;
+    FILE *snapshot_file = fopen(path, "rb");
+
+    LIBERROR_FILE_OPEN_FAILURE(snapshot_file, path);
+    LIBERROR_INIT(snapshot);
+
+#ifdef SNAPSHOT_MAPPED
+    {
+        struct stat snapshot_stat;
+
+        if(fstat(fileno(snapshot_file), &snapshot_stat) == 0 && snapshot_stat.st_size > 0) {
+            void *mapping = mmap(NULL, (size_t) snapshot_stat.st_size, PROT_READ, MAP_PRIVATE, fileno(snapshot_file), 0);
+
+            if(mapping != MAP_FAILED) {
+                snapshot.contents = mapping;
+                snapshot.length = (long) snapshot_stat.st_size;
+                snapshot.mapped = 1;
+                fclose(snapshot_file);
+
+                return snapshot;
+            }
+        }
+    }
+#endif
+
+    {
+        struct CString text;
+
+        common_parse_read_text(&text, snapshot_file);
+        snapshot.contents = text.contents;
+        snapshot.length = text.length;
+    }
+
+    fclose(snapshot_file);
+
+    return snapshot;
+}
+
+void free_snapshot(struct Snapshot snapshot) {
+#ifdef SNAPSHOT_MAPPED
+    if(snapshot.mapped == 1) {
+        munmap(snapshot.contents, (size_t) snapshot.length);
+
+        return;
+    }
+#endif
+
+    free(snapshot.contents);
+}
+
+/*
+ * Rebuild the manuals saved in a snapshot, or only those given to --only.
+ * The bodies of their sections point into the snapshot, so it must be
+ * kept until they are released.
+*/
+struct Manuals *read_snapshot(struct Snapshot snapshot, const char *path, const char *only) {
+    int manual_count = 0;
+    struct Manuals *manuals = NULL;
+    struct SnapshotReader reader;
+
+    reader.path = path;
+    reader.cursor = snapshot.contents;
+    reader.end = snapshot.contents + snapshot.length;
+
+    if(snapshot.length < (long) strlen(SNAPSHOT_MAGIC) || memcmp(snapshot.contents, SNAPSHOT_MAGIC, strlen(SNAPSHOT_MAGIC)) != 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": '%s' is not a snapshot\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    reader.cursor += strlen(SNAPSHOT_MAGIC);
+    manuals = carray_init(manuals, MANUAL);
+
+    for(manual_count = read_snapshot_int(&reader); manual_count > 0; manual_count--) {
+        int section_count = 0;
+        int reference_count = 0;
+        struct Manual manual;
+
+        LIBERROR_INIT(manual);
+        manual.parts.name = cstring_init(read_snapshot_string(&reader).contents);
+        manual.parts.sections = carray_init(manual.parts.sections, SECTION);
+        manual.parts.requests = carray_init(manual.parts.requests, EMBED_REQUEST);
+        manual.parts.references = carray_init(manual.parts.references, REFERENCE);
+
+        for(section_count = read_snapshot_int(&reader); section_count > 0; section_count--) {
+            int span_count = 0;
+            struct Section section;
+
+            LIBERROR_INIT(section);
+            section.name = common_intern(read_snapshot_string(&reader).contents);
+            section.body = carray_init(section.body, CSTRING_VIEW);
+
+            for(span_count = read_snapshot_int(&reader); span_count > 0; span_count--) {
+                struct CStringView span = read_snapshot_string(&reader);
+
+                carray_append(section.body, span, CSTRING_VIEW);
+            }
+
+            carray_append(manual.parts.sections, section, SECTION);
+        }
+
+        for(reference_count = read_snapshot_int(&reader); reference_count > 0; reference_count--) {
+            struct Reference reference;
+
+            reference.name = common_intern(read_snapshot_string(&reader).contents);
+            reference.category = common_intern(read_snapshot_string(&reader).contents);
+
+            carray_append(manual.parts.references, reference, REFERENCE);
+        }
+
+        /* The rest of a snapshot can only be found by reading through this manual */
+        if(manual_is_selected(only, manual.parts.name.contents) == 0) {
+            manual_free(manual);
+
+            continue;
+        }
+
+        carray_append(manuals, manual, MANUAL);
+    }
+
+    return manuals;
+}
+
+/*
+ * ======================
+ * #  Embed databases   #
+ * ======================
+*/
+
+/*
+ * Save the embeds of the input into an embed database, so the manuals
+ * of other inputs can request them. The embeds of the database given
+ * with --embeds are kept, unless the input defines embeds with their
+ * names, so a database can be built up a few inputs at a time.
+*/
+void write_embed_database(struct ProgramArguments arguments) {
+    struct CommonParseInput input;
+    struct Embeds *embeds = NULL;
+
+    common_parse_read_input(&input, stdin);
+    embeds = carray_init(embeds, EMBED);
+    common_parse_embeds(input, embeds);
+
+    common_parse_write_embed_database(*embeds, arguments.embed_database, arguments.write_embeds);
+
+    carray_free(embeds, EMBED);
+    common_parse_free_input(input);
+}
+
+/*
+ * ======================
+ * # Streaming manuals  #
+ * ======================
+*/
+
+/* Determine if an embed request can be met, by the embeds read so far,
+ * or by the embed database, if there is one */
+int request_is_defined(struct EmbedRequest request, const struct CommonEmbedDatabase *database) {
+    if((common_intern_flags(request.name) & EMBED_SEEN) != 0)
+        return 1;
+
+    return database != NULL && common_parse_find_database_embeds(database, request.name, NULL) > 0;
+}
+
+/* Find the first request of a manual, from start_index on, which cannot
+ * be met yet, or -1 if every one of them can */
+int find_unmet_request(struct PendingManual pending, int start_index, const struct CommonEmbedDatabase *database) {
+    int request_index = 0;
+
+    for(request_index = start_index; request_index < carray_length(pending.requests); request_index++) {
+        if(request_is_defined(pending.requests->contents[request_index], database) == 0)
+            return request_index;
+    }
+
+    return -1;
+}
+
+/* Make a manual wait on the embed of the request it is at */
+void wait_for_embed(struct WaitingLists *waiting_lists, struct WaitingManual *waiting) {
+    struct WaitingList *list = NULL;
+    int name = waiting->pending.requests->contents[waiting->request_index].name;
+
+    while(carray_length(waiting_lists) <= name) {
+        struct WaitingList empty_list = {NULL, NULL};
+
+        carray_append(waiting_lists, empty_list, WAITING_LIST);
+    }
+
+    list = waiting_lists->contents + name;
+    waiting->next = NULL;
+
+    if(list->last == NULL)
+        list->first = waiting;
+    else
+        list->last->next = waiting;
+
+    list->last = waiting;
+}
+
+/* Compare two waiting manuals by when they started waiting */
+int compare_waiting_manuals(const void *left, const void *right) {
+    const struct WaitingManual *left_manual = *(struct WaitingManual * const *) left;
+    const struct WaitingManual *right_manual = *(struct WaitingManual * const *) right;
+
+    return left_manual->order - right_manual->order;
+}
+
+/* Report each embed a manual requested that never appeared in the input */
+void report_unresolved_requests(struct PendingManual pending, const struct CommonEmbedDatabase *database) {
+    int request_index = 0;
+
+    for(request_index = 0; request_index < carray_length(pending.requests); request_index++) {
+        struct EmbedRequest request = pending.requests->contents[request_index];
+
+        if(request_is_defined(request, database) == 1)
+            continue;
+
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": manual '%s' requested embed '%s', which was never defined\n",
+                pending.name.contents, common_intern_string(request.name));
+    }
+}
+
+/*
+ * Build and write manuals while the compiled input is still being read.
+ * Groups and embeds are buffered only until their END_GROUP or END_EMBED
+ * directive, at which point their text is split into lines and parsed.
+ * A group keeps its text until it is written, and an embed keeps its
+ * text for as long as the stream lasts, since their bodies point into it.
+ *
+ * Since embeds can come after the groups that request them, a group is
+ * only rendered and written once every embed it requests has been seen.
+ * Until then, it waits in its parsed form on the first embed it is still
+ * missing, and only the manuals waiting on an embed are revisited when
+ * it arrives. Whatever is still waiting at the end of the input has its
+ * missing embeds reported, and is written with the embeds that did
+ * arrive, in the order it started waiting, which is what a regular run
+ * would have produced. As in a regular run, only the first group and
+ * the first embed with a name are used.
+*/
+void stream_manuals(FILE *location, struct ProgramArguments arguments) {
+    int in_group = 0;
+    int in_embed = 0;
+    int in_skipped = 0;
+    int waiting_count = 0;
+    struct Embeds *embeds = NULL;
+    struct CommonParseInputs *embed_inputs = NULL;
+    struct WaitingLists *waiting_lists = NULL;
+    struct ManualNames *names = NULL;
+    struct CommonParseInput record;
+    struct CString line = cstring_init("");
+    struct CString manual_path = cstring_init("");
+    struct CStringViews *tsheet_spans = NULL;
+    struct ManualSink sink;
+
+    LIBERROR_IS_NULL(location);
+
+    embeds = carray_init(embeds, EMBED);
+    embed_inputs = carray_init(embed_inputs, COMMON_PARSE_INPUT);
+    waiting_lists = carray_init(waiting_lists, WAITING_LIST);
+    names = carray_init(names, MANUAL_NAME);
+    tsheet_spans = carray_init(tsheet_spans, CSTRING_VIEW);
+    record.text = cstring_init("");
+    open_manual_sink(&sink, NULL);
+
+    while(common_parse_readline(&line, location) == 1) {
+        int embed_index = 0;
+
+        /* The group of a manual that is not written is not even buffered */
+        if(in_skipped == 1) {
+            in_skipped = strcmp(line.contents, "END_GROUP") != 0;
+
+            continue;
+        }
+
+        if(in_group == 0 && in_embed == 0) {
+            if(strncmp(line.contents, "START_GROUP", strlen("START_GROUP")) == 0)
+                in_group = 1;
+            else if(strncmp(line.contents, "START_EMBED ", strlen("START_EMBED ")) == 0)
+                in_embed = 1;
+            else
+                continue;
+
+            if(in_group == 1 && (manual_is_selected(arguments.only, strchr(line.contents, ' ') + 1) == 0
+                                 || manual_is_repeated(names, strchr(line.contents, ' ') + 1) == 1)) {
+                in_group = 0;
+                in_skipped = 1;
+
+                continue;
+            }
+        }
+
+        cstring_concat(&(record.text), line);
+        cstring_concats(&(record.text), "\n");
+
+        /* A group is finished-- write it now if we can, or wait for its embeds */
+        if(in_group == 1 && strcmp(line.contents, "END_GROUP") == 0) {
+            int request_index = 0;
+            struct PendingManual pending;
+            struct WaitingManual *waiting = NULL;
+
+            common_parse_split_input(&record);
+            pending = parse_manual(record, 0);
+            pending.owns_input = 1;
+
+            in_group = 0;
+            record.text = cstring_init("");
+            request_index = find_unmet_request(pending, 0, arguments.embed_database);
+
+            if(request_index == -1) {
+                write_pending_manual(pending, *embeds, arguments, &manual_path, tsheet_spans, &sink);
+
+                continue;
+            }
+
+            waiting = malloc(sizeof(*waiting));
+            waiting->order = waiting_count;
+            waiting->request_index = request_index;
+            waiting->pending = pending;
+            wait_for_embed(waiting_lists, waiting);
+            waiting_count++;
+
+            continue;
+        }
+
+        if(in_embed == 0 || strcmp(line.contents, "END_EMBED") != 0)
+            continue;
+
+        /* An embed is finished, which might be the last one a waiting group needed */
+        in_embed = 0;
+        embed_index = carray_length(embeds);
+        common_parse_split_input(&record);
+        common_parse_embeds(record, embeds);
+        carray_append(embed_inputs, record, COMMON_PARSE_INPUT);
+        record.text = cstring_init("");
+
+        for(; embed_index < carray_length(embeds); embed_index++) {
+            int name = embeds->contents[embed_index].name;
+            struct WaitingManual *waiting = NULL;
+
+            if((common_intern_flags(name) & EMBED_SEEN) != 0)
+                continue;
+
+            common_intern_add_flags(name, EMBED_SEEN);
+
+            if(name >= carray_length(waiting_lists))
+                continue;
+
+            /* Nothing waits on this embed from here on, so its list is
+             * taken as a whole, and each manual in it either gets written,
+             * or moves on to wait on the next embed it is missing */
+            waiting = waiting_lists->contents[name].first;
+            waiting_lists->contents[name].first = NULL;
+            waiting_lists->contents[name].last = NULL;
+
+            while(waiting != NULL) {
+                struct WaitingManual *next = waiting->next;
+
+                waiting->request_index = find_unmet_request(waiting->pending, waiting->request_index + 1,
+                                                            arguments.embed_database);
+
+                if(waiting->request_index != -1) {
+                    wait_for_embed(waiting_lists, waiting);
+                } else {
+                    write_pending_manual(waiting->pending, *embeds, arguments, &manual_path, tsheet_spans, &sink);
+                    free(waiting);
+                }
+
+                waiting = next;
+            }
+        }
+    }
+
+    /* Anything still waiting will never get its embeds */
+    {
+        int list_index = 0;
+        int remaining_count = 0;
+        int remaining_index = 0;
+        struct WaitingManual **remaining = malloc(sizeof(*remaining) * (size_t) (waiting_count + 1));
+
+        for(list_index = 0; list_index < carray_length(waiting_lists); list_index++) {
+            struct WaitingManual *waiting = waiting_lists->contents[list_index].first;
+
+            for(; waiting != NULL; waiting = waiting->next) {
+                remaining[remaining_count] = waiting;
+                remaining_count++;
+            }
+        }
+
+        qsort(remaining, (size_t) remaining_count, sizeof(*remaining), compare_waiting_manuals);
+
+        for(remaining_index = 0; remaining_index < remaining_count; remaining_index++) {
+            report_unresolved_requests(remaining[remaining_index]->pending, arguments.embed_database);
+            write_pending_manual(remaining[remaining_index]->pending, *embeds, arguments, &manual_path, tsheet_spans, &sink);
+            free(remaining[remaining_index]);
+        }
+
+        free(remaining);
+    }
+
+    close_manual_sink(&sink);
+    carray_free(embeds, EMBED);
+    carray_free(embed_inputs, COMMON_PARSE_INPUT);
+    carray_free(waiting_lists, WAITING_LIST);
+    carray_free(names, MANUAL_NAME);
+    cstring_free(record.text);
+    cstring_free(line);
+    cstring_free(manual_path);
+    carray_free(tsheet_spans, CSTRING_VIEW);
+    common_intern_free();
+}
+
+/*
+ * ==========
+ * # Server #
+ * ==========
+ *
+ * Build systems run docgen once per source file, and each of those runs
+ * pays for starting the extractor, compiler, and backend, and for reading
+ * everything from scratch. The server is a single backend that is left
+ * running, which takes jobs over a unix socket instead. A job is a source
+ * file, and the options the backend would be given for it. The server
+ * runs the compiler on the source file directly (so there is no extractor
+ * to run), and keeps the compiled input and rendered manuals of each job,
+ * along with the interned names, so a job for an unchanged file only has
+ * to write its manuals out again.
+ *
+ * A job is sent as lines of 'KEY value', ended by an empty line:
+ *   DIRECTORY  the working directory of the client. manuals are written
+ *              to the doc directory inside of it
+ *   SOURCE     the source file, relative to the directory
+ *   COMPILER   the compiler to run, either docgen-compiler-c or
+ *              docgen-compiler-m4. optional, and picked by the extension
+ *              of the source file if not given
+ *   SECTION, TITLE, DATE
+ *              the same as the options of the backend
+ *
+ * The server answers with a 'WROTE path' line for each manual it wrote,
+ * and then either 'DONE', or 'ERROR message' lines. When the compiler
+ * fails, each line it wrote to its stderr is sent as an error.
+*/
+#ifdef DOCGEN_SERVER
+void cached_job_free(struct CachedJob job) {
+    cstring_free(job.compiler);
+
+    if(job.manuals == NULL)
+        return;
+
+    carray_free(job.manuals, MANUAL);
+    common_parse_free_input(job.input);
+}
+
+/* The compilers a job can ask for. A job names one of these, rather
+ * than any program, so that a client cannot make the server run
+ * whatever it likes. */
+static const char *known_compilers[] = {
+    "docgen-compiler-c",
+    "docgen-compiler-m4",
+    NULL
+};
+
+/* Whether a compiler is one a job can ask for */
+int compiler_is_known(const char *compiler) {
+    int compiler_index = 0;
+
+    for(compiler_index = 0; known_compilers[compiler_index] != NULL; compiler_index++) {
+        if(strcmp(known_compilers[compiler_index], compiler) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* The compiler to use for a source file, if the job did not give one */
+const char *default_compiler(const char *source) {
+    size_t length = strlen(source);
+
+    if(length >= 3 && strcmp(source + length - 3, ".m4") == 0)
+        return known_compilers[1];
+
+    return known_compilers[0];
+}
+
+/* Make the address of a unix socket, or return 0 if the path does
+ * not fit in one. */
+int socket_address(struct sockaddr_un *address, const char *path) {
+    LIBERROR_INIT(*address);
+
+    if(strlen(path) >= sizeof(address->sun_path)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": socket path '%s' is too long\n", path);
+
+        return 0;
+    }
+
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path);
+
+    return 1;
+}
+
+/*
+ * Run a compiler on a source file, and read everything it writes. The
+ * compiler is ran directly rather than through a shell, so the path of
+ * the source file does not need any quoting. What it writes to its
+ * stderr goes into a temporary file rather than the stderr of the
+ * server, and is added to the errors given, so it can be sent back
+ * to the client. Returns the exit status of the compiler, or -1 if it
+ * could not be ran. The output is only kept if the status is 0.
+*/
+int run_compiler(const char *compiler, const char *source, struct CString *output, struct CString *errors) {
+    int status = 0;
+    int pipe_ends[2] = {-1, -1};
+    pid_t child = 0;
+    FILE *compiled = NULL;
+    FILE *error_file = tmpfile();
+    struct CString error_text;
+
+    if(error_file == NULL)
+        return -1;
+
+    if(pipe(pipe_ends) != 0) {
+        fclose(error_file);
+
+        return -1;
+    }
+
+    child = fork();
+
+    if(child == -1) {
+        close(pipe_ends[0]);
+        close(pipe_ends[1]);
+        fclose(error_file);
+
+        return -1;
+    }
+
+    if(child == 0) {
+        dup2(pipe_ends[1], STDOUT_FILENO);
+        dup2(fileno(error_file), STDERR_FILENO);
+        close(pipe_ends[0]);
+        close(pipe_ends[1]);
+
+        execlp(compiler, compiler, "--source", source, (char *) NULL);
+        fprintf(stderr, PROGRAM_NAME ": cannot run '%s' (%s)\n", compiler, strerror(errno));
+        _exit(127);
+    }
+
+    close(pipe_ends[1]);
+    compiled = fdopen(pipe_ends[0], "r");
+    common_parse_read_text(output, compiled);
+    fclose(compiled);
+
+    if(waitpid(child, &status, 0) == -1 || WIFEXITED(status) == 0)
+        status = -1;
+    else
+        status = WEXITSTATUS(status);
+
+    rewind(error_file);
+    common_parse_read_text(&error_text, error_file);
+    cstring_concat(errors, error_text);
+    cstring_free(error_text);
+    fclose(error_file);
+
+    if(status != 0)
+        cstring_free(*output);
+
+    return status;
+}
+
+/* Set a field of a job from a 'KEY value' line, if the line has that key */
+void read_job_field(struct CString line, const char *key, struct CString *field) {
+    size_t key_length = strlen(key);
+
+    if(strncmp(line.contents, key, key_length) != 0 || line.contents[key_length] != ' ')
+        return;
+
+    cstring_reset(field);
+    cstring_concats(field, line.contents + key_length + 1);
+}
+
+/* Read a job from a client. Returns 0 if the client went away before
+ * sending a whole job. */
+int read_job(FILE *request, struct JobRequest *job) {
+    struct CString line = cstring_init("");
+
+    while(common_parse_readline(&line, request) == 1) {
+        /* An empty line ends the job */
+        if(line.length == 0) {
+            cstring_free(line);
+
+            return 1;
+        }
+
+        read_job_field(line, "DIRECTORY", &(job->directory));
+        read_job_field(line, "SOURCE", &(job->source));
+        read_job_field(line, "COMPILER", &(job->compiler));
+        read_job_field(line, "SECTION", &(job->section));
+        read_job_field(line, "TITLE", &(job->title));
+        read_job_field(line, "DATE", &(job->date));
+        read_job_field(line, "FORMATS", &(job->formats));
+    }
+
+    cstring_free(line);
+
+    return 0;
+}
+
+/* Find the cached job for a source file, or add an empty one */
+struct CachedJob *find_cached_job(struct CachedJobs *cache, int path_id) {
+    int cache_index = 0;
+    struct CachedJob new_job;
+
+    for(cache_index = 0; cache_index < carray_length(cache); cache_index++) {
+        if(cache->contents[cache_index].path == path_id)
+            return cache->contents + cache_index;
+    }
+
+    LIBERROR_INIT(new_job);
+    new_job.path = path_id;
+    new_job.compiler = cstring_init("");
+
+    carray_append(cache, new_job, CACHED_JOB);
+
+    return cache->contents + carray_length(cache) - 1;
+}
+
+/* Compile the source of a job again. Returns 0 if the compiler failed,
+ * after sending back each line it wrote to its stderr as an error. */
+int recompile_job(struct CachedJob *cached, struct JobRequest *job, struct stat source_stat, FILE *response) {
+    int status = 0;
+    char *error_line = NULL;
+    struct CString compiled;
+    struct CString errors = cstring_init("");
+
+    if(cached->manuals != NULL) {
+        carray_free(cached->manuals, MANUAL);
+        common_parse_free_input(cached->input);
+        cached->manuals = NULL;
+    }
+
+    status = run_compiler(job->compiler.contents, job->source.contents, &compiled, &errors);
+
+    if(status != 0) {
+        for(error_line = strtok(errors.contents, "\n"); error_line != NULL; error_line = strtok(NULL, "\n")) {
+            fprintf(response, "ERROR %s\n", error_line);
+        }
+
+        fprintf(response, "ERROR compiler '%s' failed on '%s' (status %i)\n", job->compiler.contents, job->source.contents, status);
+        cstring_free(errors);
+
+        return 0;
+    }
+
+    cached->input.text = compiled;
+    common_parse_split_input(&(cached->input));
+    cached->modified = (long) source_stat.st_mtime;
+    cached->size = (long) source_stat.st_size;
+    cstring_reset(&(cached->compiler));
+    cstring_concat(&(cached->compiler), job->compiler);
+    cstring_free(errors);
+
+    return 1;
+}
+
+/* Answer a job, reusing whatever the cache has for it */
+void answer_job(struct JobRequest *job, struct CachedJobs *cache, struct ProgramArguments arguments, FILE *response) {
+    int manual_index = 0;
+    struct stat source_stat;
+    struct stat doc_stat;
+    struct CString path;
+    struct CString manual_path;
+    struct CachedJob *cached = NULL;
+    struct CStringViews *tsheet_spans = NULL;
+
+    if(job->directory.length == 0 || job->source.length == 0) {
+        fprintf(response, "ERROR a job needs both a DIRECTORY and a SOURCE\n");
+
+        return;
+    }
+
+    if(parse_formats(&arguments, job->formats.contents) == 0) {
+        fprintf(response, "ERROR unknown format in '%s'\n", job->formats.contents);
+
+        return;
+    }
+
+    if(chdir(job->directory.contents) != 0) {
+        fprintf(response, "ERROR cannot change to directory '%s' (%s)\n", job->directory.contents, strerror(errno));
+
+        return;
+    }
+
+    if(stat(job->source.contents, &source_stat) != 0) {
+        fprintf(response, "ERROR cannot read source file '%s' (%s)\n", job->source.contents, strerror(errno));
+
+        return;
+    }
+
+    if(stat("doc", &doc_stat) != 0 || S_ISDIR(doc_stat.st_mode) == 0) {
+        fprintf(response, "ERROR there is no doc directory in '%s'\n", job->directory.contents);
+
+        return;
+    }
+
+    if(job->compiler.length == 0)
+        cstring_concats(&(job->compiler), default_compiler(job->source.contents));
+
+    if(compiler_is_known(job->compiler.contents) == 0) {
+        fprintf(response, "ERROR unknown compiler '%s'\n", job->compiler.contents);
+
+        return;
+    }
+
+    /* Jobs are cached by the full path to their source file */
+    path = cstring_init("");
+
+    if(job->source.contents[0] != '/') {
+        cstring_concat(&path, job->directory);
+        cstring_concats(&path, "/");
+    }
+
+    cstring_concat(&path, job->source);
+    cached = find_cached_job(cache, common_intern(path.contents));
+    cstring_free(path);
+
+    /* The source file, or the compiler for it, changed since last time */
+    if(cached->manuals == NULL || cached->modified != (long) source_stat.st_mtime || cached->size != (long) source_stat.st_size
+       || strcmp(cached->compiler.contents, job->compiler.contents) != 0) {
+        if(recompile_job(cached, job, source_stat, response) == 0)
+            return;
+    }
+
+    if(cached->manuals == NULL)
+        cached->manuals = build_manuals(cached->input, arguments.embed_database, NULL);
+
+    arguments.section = job->section.contents;
+    arguments.title = job->title.contents;
+    arguments.date = job->date.contents;
+    manual_path = cstring_init("");
+    tsheet_spans = carray_init(tsheet_spans, CSTRING_VIEW);
+
+    for(manual_index = 0; manual_index < carray_length(cached->manuals); manual_index++) {
+        int format_index = 0;
+
+        for(format_index = 0; format_index < arguments.format_count; format_index++) {
+            write_manual_format(cached->manuals->contents + manual_index, arguments.formats[format_index], arguments,
+                                &manual_path, tsheet_spans, NULL);
+            fprintf(response, "WROTE %s\n", manual_path.contents);
+        }
+    }
+
+    fprintf(response, "DONE\n");
+
+    cstring_free(manual_path);
+    carray_free(tsheet_spans, CSTRING_VIEW);
+}
+
+/* Read a job from a client, and answer it. Options the job leaves out
+ * fall back to the options the server was started with. */
+void serve_job(FILE *request, FILE *response, struct CachedJobs *cache, struct ProgramArguments arguments) {
+    struct JobRequest job;
+
+    job.directory = cstring_init("");
+    job.source = cstring_init("");
+    job.compiler = cstring_init("");
+    job.section = cstring_init(arguments.section);
+    job.title = cstring_init(arguments.title);
+    job.date = cstring_init(arguments.date);
+    job.formats = cstring_init(arguments.format_names);
+
+    if(read_job(request, &job) == 1)
+        answer_job(&job, cache, arguments, response);
+
+    cstring_free(job.directory);
+    cstring_free(job.source);
+    cstring_free(job.compiler);
+    cstring_free(job.section);
+    cstring_free(job.title);
+    cstring_free(job.date);
+    cstring_free(job.formats);
+}
+
+/* Listen on a unix socket, and answer jobs one at a time, forever */
+int serve(struct ProgramArguments arguments) {
+    int listener = -1;
+    struct sockaddr_un address;
+    struct CachedJobs *cache = NULL;
+
+    if(socket_address(&address, arguments.serve) == 0)
+        return EXIT_FAILURE;
+
+    /* A client going away should not take the server with it */
+    signal(SIGPIPE, SIG_IGN);
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(arguments.serve);
+
+    if(listener == -1 || bind(listener, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": cannot listen on '%s' (%s)\n", arguments.serve, strerror(errno));
+
+        return EXIT_FAILURE;
+    }
+
+    cache = carray_init(cache, CACHED_JOB);
+
+    while(1) {
+        FILE *request = NULL;
+        FILE *response = NULL;
+        int connection = accept(listener, NULL, NULL);
+
+        if(connection == -1) {
+            if(errno == EINTR)
+                continue;
+
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to accept a job (%s)\n", strerror(errno));
+            break;
+        }
+
+        request = fdopen(connection, "r");
+        response = fdopen(dup(connection), "w");
+
+        serve_job(request, response, cache, arguments);
+
+        fclose(response);
+        fclose(request);
+    }
+
+    close(listener);
+    carray_free(cache, CACHED_JOB);
+
+    return EXIT_FAILURE;
+}
+
+/* Send a job to a server, and list the manuals it wrote */
+int request_job(struct ProgramArguments arguments) {
+    int connection = -1;
+    struct sockaddr_un address;
+    struct CString line;
+    FILE *request = NULL;
+    FILE *response = NULL;
+    char directory[CLIENT_DIRECTORY_LENGTH];
+
+    if(socket_address(&address, arguments.client) == 0)
+        return EXIT_FAILURE;
+
+    if(getcwd(directory, sizeof(directory)) == NULL) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": cannot get the working directory (%s)\n", strerror(errno));
+
+        return EXIT_FAILURE;
+    }
+
+    connection = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(connection == -1 || connect(connection, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": cannot connect to '%s' (%s)\n", arguments.client, strerror(errno));
+
+        return EXIT_FAILURE;
+    }
+
+    request = fdopen(dup(connection), "w");
+    response = fdopen(connection, "r");
+
+    fprintf(request, "DIRECTORY %s\n", directory);
+    fprintf(request, "SOURCE %s\n", arguments.source);
+    fprintf(request, "SECTION %s\n", arguments.section);
+    fprintf(request, "TITLE %s\n", arguments.title);
+    fprintf(request, "DATE %s\n", arguments.date);
+    fprintf(request, "FORMATS %s\n", arguments.format_names);
+    fprintf(request, "\n");
+    fclose(request);
+
+    line = cstring_init("");
+
+    while(common_parse_readline(&line, response) == 1) {
+        if(strncmp(line.contents, "WROTE ", strlen("WROTE ")) == 0) {
+            printf("%s\n", line.contents + strlen("WROTE "));
+            add_dependency_target(arguments, line.contents + strlen("WROTE "));
+
+            continue;
+        }
+
+        if(strcmp(line.contents, "DONE") == 0) {
+            cstring_free(line);
+            fclose(response);
+
+            if(arguments.depfile_targets != NULL)
+                write_dependencies(arguments);
+
+            return EXIT_SUCCESS;
+        }
+
+        if(strncmp(line.contents, "ERROR ", strlen("ERROR ")) == 0)
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": %s\n", line.contents + strlen("ERROR "));
+    }
+
+    cstring_free(line);
+    fclose(response);
+
+    return EXIT_FAILURE;
+}
+#else
+int serve(struct ProgramArguments arguments) {
+    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --serve is not supported on this platform\n");
+
+    return EXIT_FAILURE;
+}
+
+int request_job(struct ProgramArguments arguments) {
+    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --client is not supported on this platform\n");
+
+    return EXIT_FAILURE;
+}
+#endif
+
+int main(int argc, char **argv) {
+    struct Manuals *manuals = NULL;
+    struct CommonParseInput input;
+    struct Snapshot snapshot;
+    struct CStrings *index_lines = NULL;
+    struct CString depfile_targets = cstring_init("");
+    struct CommonEmbedDatabase embed_database;
+    struct ProgramArguments arguments = parse_arguments(argc, argv);
+
+    if(arguments.embeds != NULL) {
+        if(common_parse_load_embed_database(&embed_database, arguments.embeds) == 0) {
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": '%s' is not an embed database\n", arguments.embeds);
+
+            return EXIT_FAILURE;
+        }
+
+        arguments.embed_database = &embed_database;
+    }
+
+    if(arguments.serve != NULL)
+        return serve(arguments);
+
+    if(arguments.write_embeds != NULL) {
+        write_embed_database(arguments);
+
+        if(arguments.embed_database != NULL)
+            common_parse_free_embed_database(embed_database);
+
+        cstring_free(depfile_targets);
+        common_intern_free();
+
+        return 0;
+    }
+
+    if(arguments.depfile != NULL)
+        arguments.depfile_targets = &depfile_targets;
+
+    if(arguments.client != NULL)
+        return request_job(arguments);
+
+    if(arguments.index != NULL) {
+        index_lines = carray_init(index_lines, CSTRING);
+        arguments.index_lines = index_lines;
+    }
+
+    if(arguments.stream == 1) {
+        stream_manuals(stdin, arguments);
+
+        if(arguments.depfile != NULL)
+            write_dependencies(arguments);
+
+        if(arguments.index != NULL) {
+            common_index_write(index_lines, arguments.index);
+            carray_free(index_lines, CSTRING);
+        }
+
+        if(arguments.embed_database != NULL)
+            common_parse_free_embed_database(embed_database);
+
+        cstring_free(depfile_targets);
+
+        return 0;
+    }
+
+    /* A snapshot has the manuals already built, so there is no input to parse */
+    if(arguments.read_snapshot != NULL) {
+        snapshot = load_snapshot(arguments.read_snapshot);
+        manuals = read_snapshot(snapshot, arguments.read_snapshot, arguments.only);
+    } else {
+        common_parse_read_input(&input, stdin);
+        manuals = build_manuals(input, arguments.embed_database, arguments.only);
+    }
+
+    if(arguments.write_snapshot != NULL)
+        write_snapshot(manuals, arguments.write_snapshot);
+
+    /* Write each manual to its intended location */
+    write_manuals(manuals, arguments);
+
+    if(arguments.depfile != NULL)
+        write_dependencies(arguments);
+
+    if(arguments.index != NULL) {
+        common_index_write(index_lines, arguments.index);
+        carray_free(index_lines, CSTRING);
+    }
+
+    carray_free(manuals, MANUAL);
+
+    if(arguments.read_snapshot != NULL)
+        free_snapshot(snapshot);
+    else
+        common_parse_free_input(input);
+
+    if(arguments.embed_database != NULL)
+        common_parse_free_embed_database(embed_database);
+
+    cstring_free(depfile_targets);
+    common_intern_free();
 
     return 0;    
 }
@@ -43,19 +43,157 @@
 
 #define MANUAL_TYPE struct Manual
 #define MANUAL_HEAP 1
-#define MANUAL_FREE(object) cstring_free((object).name); cstring_free((object).body)
+#define MANUAL_FREE(object) manual_free(object)
+
+#define CACHED_JOB_TYPE struct CachedJob
+#define CACHED_JOB_HEAP 1
+#define CACHED_JOB_FREE(object) cached_job_free(object)
+
+#define WAITING_LIST_TYPE struct WaitingList
+#define WAITING_LIST_HEAP 1
+#define WAITING_LIST_FREE(object)
+
+#define MANUAL_NAME_TYPE int
+#define MANUAL_NAME_HEAP 1
+#define MANUAL_NAME_FREE(object)
+
+/* The flag of an interned embed name once an embed by that name
+ * has been read from a stream */
+#define EMBED_SEEN 1
+
+/* The start of every snapshot file */
+#define SNAPSHOT_MAGIC "DOCGEN SNAPSHOT 1\n"
+
+/* The layout of a ustar header, which is a block of its own. Each
+ * field is as long as the distance to the next one. */
+#define ARCHIVE_BLOCK_LENGTH        512
+#define ARCHIVE_NAME_LENGTH         100
+#define ARCHIVE_PREFIX_LENGTH       155
+#define ARCHIVE_NAME_OFFSET         0
+#define ARCHIVE_MODE_OFFSET         100
+#define ARCHIVE_UID_OFFSET          108
+#define ARCHIVE_GID_OFFSET          116
+#define ARCHIVE_SIZE_OFFSET         124
+#define ARCHIVE_MTIME_OFFSET        136
+#define ARCHIVE_CHECKSUM_OFFSET     148
+#define ARCHIVE_TYPE_OFFSET         156
+#define ARCHIVE_MAGIC_OFFSET        257
+#define ARCHIVE_PREFIX_OFFSET       345
+
+/* The manuals an io_uring writer can have in flight, and how many are
+ * queued before they are submitted. Each manual is an open, a write,
+ * and a close, which are told apart by their user data. */
+#define URING_SLOTS         64
+#define URING_BATCH         16
+#define URING_ENTRIES       256
+#define URING_OPERATIONS    3
+#define URING_OPEN          0
+#define URING_WRITE         1
+#define URING_CLOSE         2
+
+/* The number of formats manuals can be written in */
+#define MANUAL_FORMAT_COUNT 3
+
+/* Used to find the embed an embed request is asking for */
+#define EMBED_REQUEST_EMBED_COMPARE(embed, request) \
+    ((embed).name == (request).name)
 
 /* The command line arguments for the program */
 struct ProgramArguments {
     const char *section;
     const char *title;
     const char *date;
+    int stream;
+    const char *serve;
+    const char *client;
+    const char *source;
+    const char *depfile;
+
+    /* The formats to write each manual in, as given, and as found */
+    const char *format_names;
+    int format_count;
+    const struct ManualFormat *formats[MANUAL_FORMAT_COUNT];
+
+    /* Manuals written so far, as targets for the dependency file.
+     * NULL when no dependency file was asked for. */
+    struct CString *depfile_targets;
+
+    const char *write_snapshot;
+    const char *read_snapshot;
+
+    /* The index to write, and its lines so far. The lines are NULL
+     * when no index was asked for. */
+    const char *index;
+    struct CStrings *index_lines;
+
+    /* The tar archive to write the manuals into, and the time they are
+     * given in it. The archive is NULL when the manuals are written as
+     * files of their own. */
+    const char *archive;
+    unsigned long archive_modified;
+
+    /* The embed database to look embeds up in, as given, and as loaded,
+     * and the one to write */
+    const char *embeds;
+    const struct CommonEmbedDatabase *embed_database;
+    const char *write_embeds;
+
+    /* The names of the manuals to write, separated by commas. NULL when
+     * every manual is written. */
+    const char *only;
 };
 
-/* A body and name pair */
-struct Manual {
+/* Lookahead-free state of the TSHEET translation, which carries over
+ * from one span of a manual to the next. */
+struct TsheetState {
+    int in_bold_marker;
+    int in_italics_marker;
+    int in_table_marker;
+    int in_right_shift_marker;
+    char table_separator;
+};
+
+/* A group that has been parsed, but not yet rendered into a manual. The
+ * bodies of its sections point into the input it was parsed from, which
+ * it releases along with itself if it owns it. */
+struct PendingManual {
+    int owns_input;
+    struct CommonParseInput input;
     struct CString name;
-    struct CString body;
+    struct Sections *sections;
+    struct EmbedRequests *requests;
+    struct References *references;
+};
+
+/* A manual that is waiting on an embed it requests. Every request
+ * before the one it waits on can already be met. Manuals waiting on
+ * the same embed are chained in the order they started waiting. */
+struct WaitingManual {
+    int order;
+    int request_index;
+    struct PendingManual pending;
+    struct WaitingManual *next;
+};
+
+/* The manuals waiting on one embed */
+struct WaitingList {
+    struct WaitingManual *first;
+    struct WaitingManual *last;
+};
+
+/* The manuals waiting on each embed, indexed by the ID of its name */
+struct WaitingLists {
+    int length;
+    int capacity;
+    struct WaitingList *contents;
+};
+
+/* A manual, ready to be written in any format. These are the parts
+ * parsed from its group, with the embeds it requests added to its
+ * synopsis as views of their bodies, which are shared by every manual
+ * that requests them. */
+struct Manual {
+    struct PendingManual parts;
 };
 
 struct Manuals {
@@ -64,4 +202,145 @@ struct Manuals {
     struct Manual *contents;
 };
 
+/* Whether a manual was built from a group with each name yet, indexed
+ * by the ID of the name */
+struct ManualNames {
+    int length;
+    int capacity;
+    int *contents;
+};
+
+/* A manual being written in one format. The output is a rope of spans
+ * that point into the manual, the intern table, the program arguments,
+ * and static strings. The state of the TSHEET translation carries over
+ * from one piece of the manual's text to the next. */
+struct ManualWriter {
+    const struct ManualFormat *format;
+    struct TsheetState state;
+    struct CStringViews *output;
+};
+
+/* A format manuals can be written in. The layout of a manual, the
+ * escaping of its text, and the header and other rows of its tables
+ * are written by functions. The strings are what the other TSHEET markers become,
+ * where a NULL right shift or table layout means the format has none. */
+struct ManualFormat {
+    const char *name;
+    const char *extension;
+    void (*write_manual)(struct ManualWriter *writer, struct Manual *manual, struct ProgramArguments arguments);
+    void (*add_escaped)(struct CStringViews *output, const char *contents, int length);
+    void (*add_table_header)(struct ManualWriter *writer, struct CStringView row);
+    void (*add_table_row)(struct ManualWriter *writer, struct CStringView row);
+    const char *italics_start;
+    const char *italics_end;
+    const char *bold_start;
+    const char *bold_end;
+    const char *section_start;
+    const char *section_end;
+    const char *line_break;
+    const char *right_shift_start;
+    const char *right_shift_unit;
+    const char *right_shift_end;
+    const char *backslash;
+    const char *table_start;
+    const char *table_end;
+    const char *table_layout_start;
+    const char *table_layout_end;
+};
+
+/* Every manual, written in one format on its own thread */
+struct FormatJob {
+    struct Manuals *manuals;
+    const struct ManualFormat *format;
+    struct ProgramArguments arguments;
+
+    /* The archive members the job wrote, if archiving */
+    struct CString archive;
+};
+
+/* A manual being written through an io_uring. Its path and contents
+ * are kept until every operation on it completes. */
+struct UringSlot {
+    struct CString path;
+    struct CString contents;
+    int completions;
+};
+
+/* An io_uring, with its rings mapped, and the manuals it is writing */
+struct UringWriter {
+    int ring;
+    int ready;
+    unsigned queued;
+
+    void *sq_ring;
+    void *cq_ring;
+    size_t sq_ring_length;
+    size_t cq_ring_length;
+    struct io_uring_sqe *sqes;
+    size_t sqes_length;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    struct UringSlot slots[URING_SLOTS];
+};
+
+/* Where manuals are written, when it is not into files of their own
+ * straight away. Either can be NULL. */
+struct ManualSink {
+    struct CString *archive;
+    struct UringWriter *uring;
+};
+
+/* The contents of a snapshot file, which are either mapped into
+ * memory, or read into a buffer of their own */
+struct Snapshot {
+    char *contents;
+    long length;
+    int mapped;
+};
+
+/* Where a snapshot is being read from */
+struct SnapshotReader {
+    const char *path;
+    const char *cursor;
+    const char *end;
+};
+
+/* A job sent to the server */
+struct JobRequest {
+    struct CString directory;
+    struct CString source;
+    struct CString compiler;
+    struct CString section;
+    struct CString title;
+    struct CString date;
+    struct CString formats;
+};
+
+/* A job the server has done, kept between jobs. As long as the source
+ * file is unchanged, its compiled input and the manuals built from it
+ * are reused, whatever options and formats they are written with. The
+ * manuals point into the input, so both are owned by the cached job. */
+struct CachedJob {
+    int path;
+    long modified;
+    long size;
+    struct CString compiler;
+    struct CommonParseInput input;
+    struct Manuals *manuals;
+};
+
+struct CachedJobs {
+    int length;
+    int capacity;
+    struct CachedJob *contents;
+};
+
 #endif
@@ -40,6 +40,8 @@
  * number.
 */
 
+#include <string.h>
+
 #include "../../docgen.h"
 
 #include "errors.h"
@@ -48,10 +50,15 @@
  * Scan the stdin body until the index location to see which line
  * the cursor is on. The search will stop when it goes beyond the
  * given index.
+ *
+ * This is fine for a single lookup, but each call scans from the start
+ * of the body again, so anything looking up more than a few positions
+ * should build a line index once with common_errors_index_lines.
 */
 int common_errors_get_line(struct CString body, int index) {
     int line = 0;
-    int cursor = 0;
+    const char *cursor = NULL;
+    const char *end = NULL;
 
     LIBERROR_IS_NULL(body.contents);
     LIBERROR_IS_NEGATIVE(index);
@@ -61,23 +68,79 @@ int common_errors_get_line(struct CString body, int index) {
     LIBERROR_IS_VALUE(body.capacity, 0);
     LIBERROR_OUT_OF_BOUNDS(index, body.length);
 
+    cursor = body.contents;
+    end = body.contents + index;
+
     /* We can do this rather than the actual length since we verify that the
      * index to stop at is within the bounds of the length.  */
-    while(cursor < index) {
-        int character = 0;
+    while((cursor = memchr(cursor, '\n', (size_t) (end - cursor))) != NULL) {
+        line++;
+        cursor++;
+    }
 
-        LIBERROR_OUT_OF_BOUNDS(cursor, body.length);
-        character = body.contents[cursor];
+    return line;
+}
 
-        if(character != '\n') {
-            cursor++;
+/*
+ * Build an index of the offset each line of a body starts at. This is
+ * a single pass over the body, after which the line of any offset can
+ * be found with a binary search through common_errors_find_line.
+*/
+struct CommonErrorsLineIndex *common_errors_index_lines(const char *body, int length) {
+    const char *cursor = body;
+    const char *end = body + length;
+    struct CommonErrorsLineIndex *line_index = NULL;
 
-            continue;
-        }
+    LIBERROR_IS_NULL(body);
+    LIBERROR_IS_NEGATIVE(length);
 
-        line++;
+    line_index = carray_init(line_index, LINE_START);
+
+    if(length == 0)
+        return line_index;
+
+    carray_append(line_index, 0, LINE_START);
+
+    while((cursor = memchr(cursor, '\n', (size_t) (end - cursor))) != NULL) {
         cursor++;
+
+        /* A line ending right before the end does not make an extra line */
+        if(cursor == end)
+            break;
+
+        carray_append(line_index, (int) (cursor - body), LINE_START);
     }
 
-    return line;
+    return line_index;
+}
+
+/*
+ * Find the line (starting from zero) that an offset into a body is on,
+ * using an index made by common_errors_index_lines. An offset past the
+ * last line ending is on the last line.
+*/
+int common_errors_find_line(struct CommonErrorsLineIndex *line_index, int index) {
+    int low = 0;
+    int high = 0;
+
+    VERIFY_CARRAY(line_index);
+    LIBERROR_IS_NEGATIVE(index);
+
+    high = carray_length(line_index) - 1;
+
+    /* Find the last line which starts at or before the offset */
+    while(low < high) {
+        int middle = low + (high - low + 1) / 2;
+
+        if(line_index->contents[middle] <= index)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    return low;
+}
+
+void common_errors_free_lines(struct CommonErrorsLineIndex *line_index) {
+    carray_free(line_index, LINE_START);
 }
@@ -1,8 +1,24 @@
 #ifndef CWARE_DOCGEN_COMMON_ERRORS_H
 #define CWARE_DOCGEN_COMMON_ERRORS_H
 
+#define LINE_START_TYPE int
+#define LINE_START_HEAP 1
+#define LINE_START_FREE(start)
+
 struct CString;
 
+/* The offset of the start of each line in a body, in order. A line
+ * ending right before the end of the body does not start a new line. */
+struct CommonErrorsLineIndex {
+    int length;
+    int capacity;
+    int *contents;
+};
+
 int common_errors_get_line(struct CString body, int index);
 
+struct CommonErrorsLineIndex *common_errors_index_lines(const char *body, int length);
+int common_errors_find_line(struct CommonErrorsLineIndex *line_index, int index);
+void common_errors_free_lines(struct CommonErrorsLineIndex *line_index);
+
 #endif
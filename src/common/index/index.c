@@ -0,0 +1,298 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements the index of manuals, which is described in
+ * index.h. The backend adds a line to it for each manual it writes, and
+ * docgen-apropos searches it, or merges several of them into one.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "../../docgen.h"
+
+#include "../parsing/parsing.h"
+
+#include "index.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define INDEX_MAPPED 1
+#endif
+
+/* Add a field to a line, keeping it from being mistaken for the end of
+ * the field or the line */
+static void index_add_field(struct CString *line, const char *field) {
+    for(; *field != '\0'; field++) {
+        char character[2] = {0x0, 0x0};
+
+        character[0] = (unsigned char) *field < ' ' ? ' ' : *field;
+        cstring_concats(line, character);
+    }
+}
+
+void common_index_add(struct CStrings *lines, const char *name, const char *section, const char *path,
+                      const char *brief) {
+    struct CString line = cstring_init("");
+
+    LIBERROR_IS_NULL(lines);
+
+    index_add_field(&line, name);
+    cstring_concats(&line, "\t");
+    index_add_field(&line, section);
+    cstring_concats(&line, "\t");
+    index_add_field(&line, path);
+    cstring_concats(&line, "\t");
+    index_add_field(&line, brief);
+
+    carray_append(lines, line, CSTRING);
+}
+
+/* Find the end of a line, which is either its line feed, or the end of
+ * the index */
+static const char *index_line_end(struct CommonIndex index, const char *line) {
+    const char *line_end = memchr(line, '\n', (size_t) (common_index_end(index) - line));
+
+    if(line_end == NULL)
+        return common_index_end(index);
+
+    return line_end;
+}
+
+void common_index_add_lines(struct CStrings *lines, struct CommonIndex index) {
+    const char *cursor = common_index_start(index);
+
+    LIBERROR_IS_NULL(lines);
+
+    while(cursor < common_index_end(index)) {
+        const char *line_end = index_line_end(index, cursor);
+        struct CString line;
+
+        /* Skip blank lines, which a shard edited by hand could have */
+        if(line_end != cursor) {
+            line.length = (int) (line_end - cursor);
+            line.capacity = line.length + 1;
+            line.contents = malloc((size_t) line.capacity);
+
+            memcpy(line.contents, cursor, (size_t) line.length);
+            line.contents[line.length] = '\0';
+
+            carray_append(lines, line, CSTRING);
+        }
+
+        cursor = line_end + 1;
+    }
+}
+
+static int index_compare_lines(const void *a, const void *b) {
+    return strcmp(((const struct CString *) a)->contents, ((const struct CString *) b)->contents);
+}
+
+void common_index_write(struct CStrings *lines, const char *path) {
+    int line_index = 0;
+    FILE *index_file = NULL;
+
+    LIBERROR_IS_NULL(lines);
+    LIBERROR_IS_NULL(path);
+
+    index_file = fopen(path, "w");
+    LIBERROR_FILE_OPEN_FAILURE(index_file, path);
+
+    qsort(lines->contents, (size_t) carray_length(lines), sizeof(*lines->contents), index_compare_lines);
+
+    fputs(COMMON_INDEX_MAGIC, index_file);
+
+    for(line_index = 0; line_index < carray_length(lines); line_index++) {
+        struct CString line = lines->contents[line_index];
+
+        if(line_index > 0 && strcmp(lines->contents[line_index - 1].contents, line.contents) == 0)
+            continue;
+
+        fwrite(line.contents, 1, (size_t) line.length, index_file);
+        fputc('\n', index_file);
+    }
+
+    fclose(index_file);
+}
+
+int common_index_load(struct CommonIndex *index, const char *path) {
+    FILE *index_file = NULL;
+
+    LIBERROR_IS_NULL(index);
+    LIBERROR_IS_NULL(path);
+
+    index_file = fopen(path, "rb");
+    LIBERROR_FILE_OPEN_FAILURE(index_file, path);
+
+    index->contents = NULL;
+    index->length = 0;
+    index->mapped = 0;
+
+#ifdef INDEX_MAPPED
+    {
+        struct stat index_stat;
+
+        if(fstat(fileno(index_file), &index_stat) == 0 && index_stat.st_size > 0) {
+            void *mapping = mmap(NULL, (size_t) index_stat.st_size, PROT_READ, MAP_PRIVATE, fileno(index_file), 0);
+
+            if(mapping != MAP_FAILED) {
+                index->contents = mapping;
+                index->length = (long) index_stat.st_size;
+                index->mapped = 1;
+            }
+        }
+    }
+#endif
+
+    if(index->mapped == 0) {
+        struct CString text;
+
+        common_parse_read_text(&text, index_file);
+        index->contents = text.contents;
+        index->length = text.length;
+    }
+
+    fclose(index_file);
+
+    if(index->length >= (long) strlen(COMMON_INDEX_MAGIC)
+       && memcmp(index->contents, COMMON_INDEX_MAGIC, strlen(COMMON_INDEX_MAGIC)) == 0)
+        return 1;
+
+    common_index_free(*index);
+
+    return 0;
+}
+
+void common_index_free(struct CommonIndex index) {
+#ifdef INDEX_MAPPED
+    if(index.mapped == 1) {
+        munmap(index.contents, (size_t) index.length);
+
+        return;
+    }
+#endif
+
+    free(index.contents);
+}
+
+const char *common_index_start(struct CommonIndex index) {
+    return index.contents + strlen(COMMON_INDEX_MAGIC);
+}
+
+const char *common_index_end(struct CommonIndex index) {
+    return index.contents + index.length;
+}
+
+/* Read a field of a line, and move past it. The last field of a line
+ * runs to its end. */
+static struct CStringView index_read_field(const char **cursor, const char *line_end, int last) {
+    struct CStringView field;
+    const char *field_end = NULL;
+
+    if(last == 0)
+        field_end = memchr(*cursor, '\t', (size_t) (line_end - *cursor));
+
+    if(field_end == NULL)
+        field_end = line_end;
+
+    field.contents = *cursor;
+    field.length = (int) (field_end - *cursor);
+    *cursor = field_end == line_end ? line_end : field_end + 1;
+
+    return field;
+}
+
+const char *common_index_read_entry(struct CommonIndex index, const char *line, struct CommonIndexEntry *entry) {
+    const char *cursor = line;
+    const char *line_end = index_line_end(index, line);
+
+    LIBERROR_IS_NULL(entry);
+
+    entry->name = index_read_field(&cursor, line_end, 0);
+    entry->section = index_read_field(&cursor, line_end, 0);
+    entry->path = index_read_field(&cursor, line_end, 0);
+    entry->brief = index_read_field(&cursor, line_end, 1);
+
+    if(line_end == common_index_end(index))
+        return line_end;
+
+    return line_end + 1;
+}
+
+/* Compare the name of a line to a prefix. Names that start with the
+ * prefix compare equal to it. */
+static int index_compare_prefix(struct CStringView name, const char *prefix, int prefix_length) {
+    int result = memcmp(name.contents, prefix, (size_t) (name.length < prefix_length ? name.length : prefix_length));
+
+    if(result != 0)
+        return result;
+
+    return name.length < prefix_length ? -1 : 0;
+}
+
+const char *common_index_find_prefix(struct CommonIndex index, const char *prefix) {
+    int prefix_length = 0;
+    const char *low = common_index_start(index);
+    const char *high = common_index_end(index);
+
+    LIBERROR_IS_NULL(prefix);
+
+    prefix_length = (int) strlen(prefix);
+
+    /* Low is always the start of a line, and every line before it is
+     * ordered before the prefix. Every line from high on is not. */
+    while(low < high) {
+        const char *line = low + (high - low) / 2;
+        const char *next_line = NULL;
+        struct CommonIndexEntry entry;
+
+        while(line > low && line[-1] != '\n') {
+            line--;
+        }
+
+        next_line = common_index_read_entry(index, line, &entry);
+
+        if(index_compare_prefix(entry.name, prefix, prefix_length) < 0)
+            low = next_line;
+        else
+            high = line;
+    }
+
+    return low;
+}
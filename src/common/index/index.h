@@ -0,0 +1,103 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_DOCGEN_COMMON_INDEX_H
+#define CWARE_DOCGEN_COMMON_INDEX_H
+
+/* The first line of every index */
+#define COMMON_INDEX_MAGIC  "DOCGEN INDEX 1\n"
+
+/*
+ * An index of the manuals written by the backend, which can be searched
+ * without reading the manuals themselves. It is a text file that starts
+ * with COMMON_INDEX_MAGIC, followed by a line for each manual:
+ *
+ *   NAME <tab> SECTION <tab> PATH <tab> BRIEF
+ *
+ * The lines are sorted by their bytes. No field can contain a tab, or
+ * anything below a space, so this sorts the lines by the name of their
+ * manual, and then by its section. Since an index is sorted, a name can
+ * be looked up in it with a binary search, and indexes can be merged
+ * by sorting their lines together.
+*/
+struct CommonIndex {
+    char *contents;
+    long length;
+    int mapped;
+};
+
+/* The fields of a line of an index, which point into the index */
+struct CommonIndexEntry {
+    struct CStringView name;
+    struct CStringView section;
+    struct CStringView path;
+    struct CStringView brief;
+};
+
+/* Add a line for a manual to the lines of an index. Tabs, and anything
+ * else below a space, in the fields are replaced with spaces. */
+void common_index_add(struct CStrings *lines, const char *name, const char *section, const char *path,
+                      const char *brief);
+
+/* Add every line of an index to the lines of another */
+void common_index_add_lines(struct CStrings *lines, struct CommonIndex index);
+
+/* Sort the lines of an index, and write them to a file. Lines that are
+ * the same are only written once. */
+void common_index_write(struct CStrings *lines, const char *path);
+
+/* Load an index. It is mapped into memory where that is available, and
+ * read into a buffer of its own where it is not. Returns 0 if the file
+ * is not an index, in which case there is nothing to release. */
+int common_index_load(struct CommonIndex *index, const char *path);
+
+/* Release an index */
+void common_index_free(struct CommonIndex index);
+
+/* Retrieve the first line of an index, and the end of its last one */
+const char *common_index_start(struct CommonIndex index);
+const char *common_index_end(struct CommonIndex index);
+
+/* Split a line of an index into its fields, and return the line after it */
+const char *common_index_read_entry(struct CommonIndex index, const char *line, struct CommonIndexEntry *entry);
+
+/* Find the first line whose name is not ordered before a prefix, which
+ * is where the lines whose names start with the prefix begin. This is a
+ * binary search, so only a few lines of the index are ever looked at. */
+const char *common_index_find_prefix(struct CommonIndex index, const char *prefix);
+
+#endif
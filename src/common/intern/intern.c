@@ -0,0 +1,236 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * This file implements the intern table, which stores each distinct name
+ * (sections, embeds, references, tags) exactly once. Each name is given
+ * an integer ID, so names can be compared with a single integer compare
+ * rather than with strcmp, and structures that hold a name do not need
+ * to allocate a copy of it.
+ *
+ * The table is global, since names are shared between everything a
+ * program parses. Strings are looked up through an open addressing hash
+ * table of IDs, which is doubled whenever it becomes half full.
+*/
+
+#include "../../docgen.h"
+
+#include "intern.h"
+
+#define INTERN_ENTRY_TYPE   struct InternEntry
+#define INTERN_ENTRY_HEAP   1
+#define INTERN_ENTRY_FREE(entry) \
+    free((entry).string)
+
+#define INTERN_INITIAL_BUCKETS  256
+
+struct InternEntry {
+    char *string;
+    int length;
+    int flags;
+    unsigned long hash;
+};
+
+struct InternEntries {
+    int length;
+    int capacity;
+    struct InternEntry *contents;
+};
+
+static struct InternEntries *intern_entries = NULL;
+
+/* Each bucket holds an ID, or -1 if it is empty */
+static int *intern_buckets = NULL;
+static int intern_bucket_count = 0;
+
+static unsigned long intern_hash(const char *string, int length) {
+    int index = 0;
+    unsigned long hash = 2166136261UL;
+
+    for(index = 0; index < length; index++) {
+        hash ^= (unsigned char) string[index];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+static void intern_allocate_buckets(int count) {
+    int index = 0;
+
+    intern_buckets = malloc(sizeof(*intern_buckets) * (size_t) count);
+    intern_bucket_count = count;
+
+    for(index = 0; index < count; index++) {
+        intern_buckets[index] = -1;
+    }
+}
+
+/* Double the amount of buckets, and put every ID back into one */
+static void intern_grow_buckets(void) {
+    int id = 0;
+
+    free(intern_buckets);
+    intern_allocate_buckets(intern_bucket_count * 2);
+
+    for(id = 0; id < carray_length(intern_entries); id++) {
+        unsigned long bucket = intern_entries->contents[id].hash & (unsigned long) (intern_bucket_count - 1);
+
+        while(intern_buckets[bucket] != -1) {
+            bucket = (bucket + 1) & (unsigned long) (intern_bucket_count - 1);
+        }
+
+        intern_buckets[bucket] = id;
+    }
+}
+
+/* Find the bucket a string is in, or the empty bucket it would go in */
+static unsigned long intern_find_bucket(const char *string, int length, unsigned long hash) {
+    unsigned long bucket = hash & (unsigned long) (intern_bucket_count - 1);
+
+    while(intern_buckets[bucket] != -1) {
+        struct InternEntry entry = intern_entries->contents[intern_buckets[bucket]];
+
+        if(entry.hash == hash && entry.length == length && strncmp(entry.string, string, (size_t) length) == 0)
+            return bucket;
+
+        bucket = (bucket + 1) & (unsigned long) (intern_bucket_count - 1);
+    }
+
+    return bucket;
+}
+
+int common_intern_length(const char *string, int length) {
+    unsigned long hash = 0;
+    unsigned long bucket = 0;
+    struct InternEntry entry;
+
+    LIBERROR_IS_NULL(string);
+    LIBERROR_IS_NEGATIVE(length);
+
+    if(intern_entries == NULL) {
+        intern_entries = carray_init(intern_entries, INTERN_ENTRY);
+        intern_allocate_buckets(INTERN_INITIAL_BUCKETS);
+    }
+
+    hash = intern_hash(string, length);
+    bucket = intern_find_bucket(string, length, hash);
+
+    if(intern_buckets[bucket] != -1)
+        return intern_buckets[bucket];
+
+    entry.string = malloc((size_t) length + 1);
+    entry.length = length;
+    entry.flags = 0;
+    entry.hash = hash;
+
+    memcpy(entry.string, string, (size_t) length);
+    entry.string[length] = '\0';
+
+    carray_append(intern_entries, entry, INTERN_ENTRY);
+    intern_buckets[bucket] = carray_length(intern_entries) - 1;
+
+    /* Keep at least half of the buckets empty so probes stay short */
+    if(carray_length(intern_entries) * 2 >= intern_bucket_count)
+        intern_grow_buckets();
+
+    return carray_length(intern_entries) - 1;
+}
+
+int common_intern(const char *string) {
+    LIBERROR_IS_NULL(string);
+
+    return common_intern_length(string, (int) strlen(string));
+}
+
+int common_intern_find(const char *string) {
+    int length = 0;
+    unsigned long bucket = 0;
+
+    LIBERROR_IS_NULL(string);
+
+    if(intern_entries == NULL)
+        return COMMON_INTERN_MISSING;
+
+    length = (int) strlen(string);
+    bucket = intern_find_bucket(string, length, intern_hash(string, length));
+
+    if(intern_buckets[bucket] == -1)
+        return COMMON_INTERN_MISSING;
+
+    return intern_buckets[bucket];
+}
+
+const char *common_intern_string(int id) {
+    LIBERROR_IS_NULL(intern_entries);
+    LIBERROR_OUT_OF_BOUNDS(id, carray_length(intern_entries));
+
+    return intern_entries->contents[id].string;
+}
+
+int common_intern_string_length(int id) {
+    LIBERROR_IS_NULL(intern_entries);
+    LIBERROR_OUT_OF_BOUNDS(id, carray_length(intern_entries));
+
+    return intern_entries->contents[id].length;
+}
+
+void common_intern_add_flags(int id, int flags) {
+    LIBERROR_IS_NULL(intern_entries);
+    LIBERROR_OUT_OF_BOUNDS(id, carray_length(intern_entries));
+
+    intern_entries->contents[id].flags |= flags;
+}
+
+int common_intern_flags(int id) {
+    LIBERROR_IS_NULL(intern_entries);
+    LIBERROR_OUT_OF_BOUNDS(id, carray_length(intern_entries));
+
+    return intern_entries->contents[id].flags;
+}
+
+void common_intern_free(void) {
+    if(intern_entries == NULL)
+        return;
+
+    carray_free(intern_entries, INTERN_ENTRY);
+    free(intern_buckets);
+
+    intern_entries = NULL;
+    intern_buckets = NULL;
+    intern_bucket_count = 0;
+}
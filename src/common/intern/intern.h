@@ -0,0 +1,72 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_DOCGEN_COMMON_INTERN_H
+#define CWARE_DOCGEN_COMMON_INTERN_H
+
+/* Returned by common_intern_find when a string was never interned */
+#define COMMON_INTERN_MISSING   -1
+
+/* Intern a string, returning its ID. Interning the same string again
+ * returns the same ID, so two IDs are equal only if their strings are. */
+int common_intern(const char *string);
+
+/* Intern the first length characters of a string */
+int common_intern_length(const char *string, int length);
+
+/* Retrieve the ID of a string without interning it. Returns
+ * COMMON_INTERN_MISSING if it was never interned. */
+int common_intern_find(const char *string);
+
+/* Retrieve the string an ID was given to */
+const char *common_intern_string(int id);
+
+/* Retrieve the length of the string an ID was given to */
+int common_intern_string_length(int id);
+
+/* Attach flags to an interned string, which can be used to classify
+ * the string without comparing it against others. */
+void common_intern_add_flags(int id, int flags);
+
+/* Retrieve the flags of an interned string */
+int common_intern_flags(int id);
+
+/* Release every interned string. Any IDs given out before this are
+ * no longer valid. */
+void common_intern_free(void);
+
+#endif
@@ -39,13 +39,25 @@
  * This file implements common file parsing routines.
 */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <ctype.h>
 
 #include "../../docgen.h"
 
 #include "parsing.h"
+#include "../errors/errors.h"
+#include "../intern/intern.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define EMBED_DATABASE_MAPPED 1
+#endif
 
 #define LINE_LENGTH 128
+#define INPUT_BLOCK_LENGTH 4096
 
 /*
  * This function will read lines from a file location into an
@@ -237,6 +249,251 @@ int common_parse_readlines(struct CStrings *array, FILE *location) {
     return actual_lines;
 }
 
+/*
+ * Read a single line from a file location into a cstring, without
+ * the line ending. This follows the same rules as common_parse_readlines
+ * does for each line, so a final line without a line ending is still
+ * a line, but a line ending right before the end of the file does not
+ * make an extra empty line.
+ *
+ * This is used by the streaming modes, which cannot afford to hold
+ * the entire input in memory before doing any work with it. Returns
+ * 1 if a line was read, and 0 if the end of the file was met before
+ * any characters were read.
+*/
+int common_parse_readline(struct CString *line, FILE *location) {
+    int character = -1;
+    int buffer_length = 0;
+    char line_buffer[LINE_LENGTH + 1] = "";
+
+    VERIFY_CSTRING(line);
+    LIBERROR_IS_NULL(location);
+
+    cstring_reset(line);
+
+    while((character = fgetc(location)) != '\n') {
+        /* End of file is met before the line ending. Flush whatever
+         * we have, and only consider it a line if we read anything. */
+        if(character == EOF) {
+            line_buffer[buffer_length] = '\0';
+            cstring_concats(line, line_buffer);
+
+            return line->length > 0;
+        }
+
+        LIBERROR_OUT_OF_BOUNDS(buffer_length, LINE_LENGTH);
+
+        line_buffer[buffer_length] = character;
+        buffer_length++;
+
+        /* Line buffer is not full. Do not flush it yet. */
+        if(buffer_length < LINE_LENGTH)
+            continue;
+
+        line_buffer[buffer_length] = '\0';
+        cstring_concats(line, line_buffer);
+        buffer_length = 0;
+    }
+
+    line_buffer[buffer_length] = '\0';
+    cstring_concats(line, line_buffer);
+
+    return 1;
+}
+
+/*
+ * Read the entirety of a file location into a string. The text is read
+ * in blocks into a buffer that doubles in size, rather than a line or
+ * a character at a time.
+*/
+void common_parse_read_text(struct CString *text, FILE *location) {
+    size_t read_length = 0;
+
+    LIBERROR_IS_NULL(text);
+    LIBERROR_IS_NULL(location);
+
+    text->length = 0;
+    text->capacity = INPUT_BLOCK_LENGTH + 1;
+    text->contents = malloc((size_t) text->capacity);
+
+    while((read_length = fread(text->contents + text->length, 1,
+                               (size_t) (text->capacity - text->length - 1), location)) != 0) {
+        text->length += (int) read_length;
+
+        if(text->length < text->capacity - 1)
+            continue;
+
+        text->capacity = (text->capacity - 1) * 2 + 1;
+        text->contents = realloc(text->contents, (size_t) text->capacity);
+    }
+
+    text->contents[text->length] = '\0';
+}
+
+/* Read the entirety of a file location into the input's text, and
+ * split it into lines. */
+void common_parse_read_input(struct CommonParseInput *input, FILE *location) {
+    LIBERROR_IS_NULL(input);
+    LIBERROR_IS_NULL(location);
+
+    common_parse_read_text(&(input->text), location);
+    common_parse_split_input(input);
+}
+
+/*
+ * Split the text of an input into its lines. The lines follow the
+ * same rules as common_parse_readlines does, but instead of copying
+ * each line into its own string, the text is copied once with each
+ * line ending replaced by a NUL, and each line points into that copy.
+ *
+ * The lines are found through an index of where each line starts, which
+ * is kept with the input for looking up the line of an offset later.
+ *
+ * Since a line is at the same offset in both the text and the copy,
+ * any run of lines can be viewed in the text, with their line endings,
+ * by translating the address of its first line. This is what lets the
+ * bodies of sections and embeds be views rather than copies.
+*/
+void common_parse_split_input(struct CommonParseInput *input) {
+    int line_index = 0;
+
+    LIBERROR_IS_NULL(input);
+    VERIFY_CSTRING(&(input->text));
+
+    input->terminated = malloc((size_t) input->text.length + 1);
+    input->lines = carray_init(input->lines, BORROWED_CSTRING);
+    input->line_starts = common_errors_index_lines(input->text.contents, input->text.length);
+
+    memcpy(input->terminated, input->text.contents, (size_t) input->text.length + 1);
+
+    for(line_index = 0; line_index < carray_length(input->line_starts); line_index++) {
+        struct CString line;
+        int line_start = input->line_starts->contents[line_index];
+        int line_end = input->text.length;
+
+        /* Each line ends right before the next one starts. The last line
+         * ends at the end of the text, unless the text ends with a line
+         * ending. */
+        if(line_index + 1 < carray_length(input->line_starts))
+            line_end = input->line_starts->contents[line_index + 1] - 1;
+        else if(input->terminated[line_end - 1] == '\n')
+            line_end--;
+
+        input->terminated[line_end] = '\0';
+
+        line.contents = input->terminated + line_start;
+        line.length = line_end - line_start;
+        line.capacity = line.length + 1;
+
+        carray_append(input->lines, line, BORROWED_CSTRING);
+    }
+}
+
+void common_parse_free_input(struct CommonParseInput input) {
+    cstring_free(input.text);
+    free(input.terminated);
+    common_errors_free_lines(input.line_starts);
+    carray_free(input.lines, BORROWED_CSTRING);
+}
+
+/*
+ * View the lines of an input from the start index, up to but not including
+ * the end index, with the line ending of each line. Every line in the view
+ * must have a line ending, which is always true of the lines in a body, as
+ * the directive which ends the body comes after them.
+*/
+struct CStringView common_parse_view_lines(struct CommonParseInput input, int start_index, int end_index) {
+    struct CStringView view;
+    struct CString last_line;
+
+    VERIFY_CARRAY(input.lines);
+    LIBERROR_IS_NEGATIVE(start_index);
+    LIBERROR_INIT(view);
+
+    view.contents = input.text.contents;
+    view.length = 0;
+
+    if(end_index <= start_index)
+        return view;
+
+    LIBERROR_OUT_OF_BOUNDS(end_index - 1, carray_length(input.lines));
+
+    last_line = input.lines->contents[end_index - 1];
+
+    view.contents = input.text.contents + (input.lines->contents[start_index].contents - input.terminated);
+    view.length = (int) ((last_line.contents + last_line.length + 1) - input.lines->contents[start_index].contents);
+
+    return view;
+}
+
+/* Add the lines between the start and end index to the end of a
+ * section's body. */
+void common_parse_add_body(struct CommonParseInput input, struct Section *section, int start_index, int end_index) {
+    struct CStringView view;
+
+    LIBERROR_IS_NULL(section);
+    VERIFY_CARRAY(section->body);
+
+    view = common_parse_view_lines(input, start_index, end_index);
+
+    if(view.length == 0)
+        return;
+
+    carray_append(section->body, view, CSTRING_VIEW);
+}
+
+/* Make a view of an entire string */
+struct CStringView common_parse_view_string(const char *string) {
+    struct CStringView view;
+
+    LIBERROR_IS_NULL(string);
+
+    view.contents = string;
+    view.length = (int) strlen(string);
+
+    return view;
+}
+
+/* The combined length of each view */
+int common_parse_views_length(struct CStringViews views) {
+    int length = 0;
+    int view_index = 0;
+
+    for(view_index = 0; view_index < carray_length(&views); view_index++) {
+        length += views.contents[view_index].length;
+    }
+
+    return length;
+}
+
+/* Concatenate a view onto the end of a string */
+void common_parse_concat_view(struct CString *location, struct CStringView view) {
+    struct CString view_string;
+
+    VERIFY_CSTRING(location);
+
+    /* Like cstring_concats, the view is not modified by the concatenation,
+     * so casting away its const is safe here. */
+    view_string.length = view.length;
+    view_string.capacity = view.length + 1;
+    view_string.contents = (char *) view.contents;
+
+    cstring_concat(location, view_string);
+}
+
+/* Concatenate each view onto the end of a string */
+void common_parse_concat_views(struct CString *location, struct CStringViews views) {
+    int view_index = 0;
+
+    for(view_index = 0; view_index < carray_length(&views); view_index++) {
+        common_parse_concat_view(location, views.contents[view_index]);
+    }
+}
+
+void common_parse_free_section(struct Section section) {
+    carray_free(section.body, CSTRING_VIEW);
+}
+
 /*
  * Determine whether or noot the line provided has a docgen tag on it.
  * It is determined based off looping through the string, and if an '@'
@@ -300,6 +557,114 @@ int common_parse_get_tag_index(struct CString line) {
     return -1;
 }
 
+/*
+ * Find the next line of a text with the given tag, which must not run on
+ * into a longer tag name, the same way common_parse_read_tag reads it. Only
+ * the '@' signs of the text are looked at, and they are found
+ * with memchr, so text without any is passed over in a single scan. An
+ * '@' only counts if it is where common_parse_get_tag_index would find
+ * the tag of its line, so tags in strings and later on a line are not.
+*/
+const char *common_parse_find_tag_line(const char *text, const char *cursor, const char *end, const char *tag) {
+    size_t tag_length = 0;
+
+    LIBERROR_IS_NULL(text);
+    LIBERROR_IS_NULL(cursor);
+    LIBERROR_IS_NULL(end);
+    LIBERROR_IS_NULL(tag);
+
+    tag_length = strlen(tag);
+
+    while(cursor < end) {
+        struct CString line;
+        const char *line_start = NULL;
+        const char *at_sign = memchr(cursor, '@', (size_t) (end - cursor));
+
+        if(at_sign == NULL)
+            return NULL;
+
+        cursor = at_sign + 1;
+
+        if((size_t) (end - at_sign) < tag_length || memcmp(at_sign, tag, tag_length) != 0)
+            continue;
+
+        /* A longer tag, like @docgen_starting */
+        if(at_sign + tag_length < end && at_sign[tag_length] != '\0'
+           && strchr(CLASS_ALPHA "_", at_sign[tag_length]) != NULL)
+            continue;
+
+        for(line_start = at_sign; line_start > text && line_start[-1] != '\n'; line_start--)
+            ;
+
+        line.contents = (char *) line_start;
+        line.length = (int) (at_sign - line_start) + 1;
+        line.capacity = line.length + 1;
+
+        if(common_parse_get_tag_index(line) == line.length - 1)
+            return line_start;
+    }
+
+    return NULL;
+}
+
+/*
+ * Find each docgen block of a text before it is split into lines. Only
+ * the '@' signs of the text are looked at to find the start tag of a
+ * block, so text without any blocks costs a single scan of memory, and
+ * the text outside of the blocks is never split into lines at all. The
+ * extractors and the compilers' --source both find their tags this way,
+ * so they agree on which '@' signs are tags.
+ *
+ * A block that is never closed runs to the next end tag, or to the end
+ * of the text, so the compiler still sees, and reports, its tags. The
+ * line each block starts on is looked up in an index of the lines of
+ * the text, which is only built once the first block is found.
+*/
+void common_parse_find_blocks(struct CString text, struct TextBlocks *blocks) {
+    const char *cursor = text.contents;
+    const char *text_end = text.contents + text.length;
+    struct CommonErrorsLineIndex *line_starts = NULL;
+
+    VERIFY_CSTRING(&text);
+    LIBERROR_IS_NULL(blocks);
+
+    while((cursor = common_parse_find_tag_line(text.contents, cursor, text_end, COMMON_PARSE_BLOCK_START)) != NULL) {
+        struct TextBlock block;
+        const char *block_end = common_parse_find_tag_line(text.contents, cursor + strlen(COMMON_PARSE_BLOCK_START),
+                                                           text_end, COMMON_PARSE_BLOCK_END);
+
+        block.closed = block_end != NULL;
+
+        /* The block ends right after the line with its end tag */
+        if(block_end == NULL) {
+            block_end = text_end;
+        } else {
+            block_end = memchr(block_end, '\n', (size_t) (text_end - block_end));
+            block_end = block_end == NULL ? text_end : block_end + 1;
+        }
+
+        if(line_starts == NULL)
+            line_starts = common_errors_index_lines(text.contents, text.length);
+
+        block.start = cursor;
+        block.end = block_end;
+        block.line_index = common_errors_find_line(line_starts, CHAR_OFFSET(text.contents, cursor));
+
+        /* Another block starting before this one ends means this one
+         * was never closed */
+        if(common_parse_find_tag_line(text.contents, cursor + strlen(COMMON_PARSE_BLOCK_START), block_end,
+                                      COMMON_PARSE_BLOCK_START) != NULL)
+            block.closed = 0;
+
+        carray_append(blocks, block, TEXT_BLOCK);
+
+        cursor = block_end;
+    }
+
+    if(line_starts != NULL)
+        common_errors_free_lines(line_starts);
+}
+
 /* This function will read the name of a tag from a line, and write it
  * into the given cstring. The name of the tag is defined as all the text
  * from the first '@' to the first non-alphabetical or underscore character.
@@ -367,15 +732,33 @@ void common_parse_upper_string(FILE *location, const char *string, int length) {
  * # Common backend parsing functions #
  * ===================================
 */
-void common_parse_embeds(struct CStrings lines, struct Embeds *array) {
+/* View the body of an embed without its comment, which is its first
+ * line. An embed with no lines at all has nothing to remove. */
+static struct CStringView common_parse_uncomment(struct CStringView body) {
+    const char *comment_end = memchr(body.contents, '\n', (size_t) body.length);
+
+    if(comment_end == NULL)
+        comment_end = body.contents + body.length - 1;
+
+    body.length -= (int) (comment_end + 1 - body.contents);
+    body.contents = comment_end + 1;
+
+    return body;
+}
+
+void common_parse_embeds(struct CommonParseInput input, struct Embeds *array) {
     int in_body = 0;
+    int body_start = 0;
     int line_index = 0;
     struct Embed embed;
+    struct CStrings lines;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_INIT(embed);
 
+    lines = *input.lines;
+
     for(line_index = 0; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
 
@@ -389,49 +772,42 @@ void common_parse_embeds(struct CStrings lines, struct Embeds *array) {
         if(strncmp(line.contents, "START_EMBED ", strlen("START_EMBED ")) != 0) {
             /* Stop parsing the body string (since theres no space after,
              * theres no need for the extra space */
-            if(strcmp(line.contents, "END_EMBED") == 0) {
+            if(in_body == 1 && strcmp(line.contents, "END_EMBED") == 0) {
                 in_body = 0;
+                embed.body = common_parse_view_lines(input, body_start, line_index);
+                embed.uncommented = common_parse_uncomment(embed.body);
                 carray_append(array, embed, EMBED);
-
-                continue; 
             }
 
-            /* If this is 1, we know we passed "START_EMBED ", and we have not
-             * yet met "END_EMBED ". */
-            if(in_body == 0)
-                continue;
-
-            cstring_concats(&embed.body, line.contents);
-            cstring_concats(&embed.body, "\n");
-
             continue;
         }
 
-
         /* We will only get here once, which is when "START_EMBED " is found.
-         * Every other time when the string is not START_EMBED, it will add
-         * text to the body. */
-        embed.name = cstring_init("");
-        embed.body = cstring_init("");
+         * The body is every line between the type and "END_EMBED". */
+        LIBERROR_OUT_OF_BOUNDS(line_index + 1, carray_length(&lines));
 
         /* Get the name and type */
-        cstring_concats(&(embed.name), strchr(line.contents, ' ') + 1);
+        embed.name = common_intern(strchr(line.contents, ' ') + 1);
         embed.type = strtoul(lines.contents[line_index + 1].contents, NULL, 10);
 
         in_body = 1;
 
         /* Type is the first 'line' after the directive, so we skip it */
         line_index++;
+        body_start = line_index + 1;
     }
 }
 
-void common_parse_embed_requests(struct CStrings lines, struct EmbedRequests *array, int start_index) {
+void common_parse_embed_requests(struct CommonParseInput input, struct EmbedRequests *array, int start_index) {
     int line_index = 0;
+    struct CStrings lines;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_IS_NEGATIVE(start_index);
 
+    lines = *input.lines;
+
     for(line_index = start_index; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
         struct EmbedRequest embed_request;
@@ -452,8 +828,7 @@ void common_parse_embed_requests(struct CStrings lines, struct EmbedRequests *ar
         LIBERROR_OUT_OF_BOUNDS(line_index + 1, carray_length(&lines));
 
         /* Add a new embed request */
-        embed_request.name = cstring_init("");
-        cstring_concats(&(embed_request.name), strchr(lines.contents[line_index].contents, ' ') + 1);
+        embed_request.name = common_intern(strchr(lines.contents[line_index].contents, ' ') + 1);
 
         /* Are comments allowed? */
         embed_request.allow_comment = strtoul(lines.contents[line_index + 1].contents, NULL, 10);
@@ -462,16 +837,20 @@ void common_parse_embed_requests(struct CStrings lines, struct EmbedRequests *ar
     }
 }
 
-void common_parse_prepends(struct CStrings lines, struct Sections *array, int start_index) {
+void common_parse_prepends(struct CommonParseInput input, struct Sections *array, int start_index) {
     int in_body = 0;
+    int body_start = 0;
     int line_index = 0;
+    struct CStrings lines;
     struct Section *section = NULL;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_IS_NEGATIVE(start_index);
     LIBERROR_INIT(section);
 
+    lines = *input.lines;
+
     /* First things first-- let's collect all of the prepends */
     for(line_index = start_index; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
@@ -482,8 +861,12 @@ void common_parse_prepends(struct CStrings lines, struct Sections *array, int st
         line = lines.contents[line_index];
 
         /* Stop when we find the end of this group */
-        if(strcmp(line.contents, "END_GROUP") == 0)
+        if(strcmp(line.contents, "END_GROUP") == 0) {
+            if(in_body == 1)
+                common_parse_add_body(input, section, body_start, line_index);
+
             break;
+        }
 
         /* Start a new section, or use an existing one. */
         if(strncmp(line.contents, "START_PREPEND_TO", strlen("START_PREPEND_TO")) == 0) {
@@ -493,19 +876,20 @@ void common_parse_prepends(struct CStrings lines, struct Sections *array, int st
             LIBERROR_INIT(search);
 
             in_body = 1; 
+            body_start = line_index + 1;
 
             /* If the section already exists, we should use the existing one. */
-            search.name.contents = strchr(line.contents, ' ') + 1;
+            search.name = common_intern(strchr(line.contents, ' ') + 1);
             exists = carray_find(array, search, exists, SECTION);
 
             if(exists == -1) {
                 struct Section new_section;
 
-                new_section.name = cstring_init(""); 
-                new_section.body = cstring_init(""); 
+                LIBERROR_INIT(new_section);
+                new_section.body = carray_init(new_section.body, CSTRING_VIEW);
 
                 /* All we can know from this line is the name of the section */
-                cstring_concats(&(new_section.name), strchr(line.contents, ' ') + 1);
+                new_section.name = search.name;
 
                 carray_append(array, new_section, SECTION);
                 section = array->contents + (carray_length(array) - 1);
@@ -518,30 +902,28 @@ void common_parse_prepends(struct CStrings lines, struct Sections *array, int st
 
         /* Stop when the line is the end of a group */
         if(strcmp(line.contents, "END_PREPEND_TO") == 0) {
+            common_parse_add_body(input, section, body_start, line_index);
             in_body = 0;
 
             continue;
         }
-
-        if(in_body == 0)
-            continue;
-
-        /* Construct the body */
-        cstring_concats(&(section->body), line.contents);
-        cstring_concats(&(section->body), "\n");
     }
 }
 
-void common_parse_sections(struct CStrings lines, struct Sections *array, int start_index) {
+void common_parse_sections(struct CommonParseInput input, struct Sections *array, int start_index) {
     int in_body = 0;
+    int body_start = 0;
     int line_index = 0;
+    struct CStrings lines;
     struct Section *section = NULL;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_IS_NEGATIVE(start_index);
     LIBERROR_INIT(section);
 
+    lines = *input.lines;
+
     /* Next, let's collect all of the base sections */
     for(line_index = start_index; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
@@ -552,8 +934,12 @@ void common_parse_sections(struct CStrings lines, struct Sections *array, int st
         line = lines.contents[line_index];
 
         /* Stop when we find the end of this group */
-        if(strcmp(line.contents, "END_GROUP") == 0)
+        if(strcmp(line.contents, "END_GROUP") == 0) {
+            if(in_body == 1)
+                common_parse_add_body(input, section, body_start, line_index);
+
             break;
+        }
 
         /* Start a new section, or use an existing one. */
         if(strncmp(line.contents, "START_SECTION", strlen("START_SECTION")) == 0) {
@@ -563,19 +949,20 @@ void common_parse_sections(struct CStrings lines, struct Sections *array, int st
             LIBERROR_INIT(search);
 
             in_body = 1; 
+            body_start = line_index + 1;
 
             /* If the section already exists, we should use the existing one. */
-            search.name.contents = strchr(line.contents, ' ') + 1;
+            search.name = common_intern(strchr(line.contents, ' ') + 1);
             exists = carray_find(array, search, exists, SECTION);
 
             if(exists == -1) {
                 struct Section new_section;
 
-                new_section.name = cstring_init(""); 
-                new_section.body = cstring_init(""); 
+                LIBERROR_INIT(new_section);
+                new_section.body = carray_init(new_section.body, CSTRING_VIEW);
 
                 /* All we can know from this line is the name of the section */
-                cstring_concats(&(new_section.name), strchr(line.contents, ' ') + 1);
+                new_section.name = search.name;
 
                 carray_append(array, new_section, SECTION);
                 section = array->contents + (carray_length(array) - 1);
@@ -588,30 +975,28 @@ void common_parse_sections(struct CStrings lines, struct Sections *array, int st
 
         /* Stop when the line is the end of a group */
         if(strcmp(line.contents, "END_SECTION") == 0) {
+            common_parse_add_body(input, section, body_start, line_index);
             in_body = 0;
 
             continue;
         }
-
-        if(in_body == 0)
-            continue;
-
-        /* Construct the body */
-        cstring_concats(&(section->body), line.contents);
-        cstring_concats(&(section->body), "\n");
     }
 }
 
-void common_parse_appends(struct CStrings lines, struct Sections *array, int start_index) {
+void common_parse_appends(struct CommonParseInput input, struct Sections *array, int start_index) {
     int in_body = 0;
+    int body_start = 0;
     int line_index = 0;
+    struct CStrings lines;
     struct Section *section = NULL;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_IS_NEGATIVE(start_index);
     LIBERROR_INIT(section);
 
+    lines = *input.lines;
+
     /* Next, let's collect all of the base sections */
     for(line_index = start_index; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
@@ -622,8 +1007,12 @@ void common_parse_appends(struct CStrings lines, struct Sections *array, int sta
         line = lines.contents[line_index];
 
         /* Stop when we find the end of this group */
-        if(strcmp(line.contents, "END_GROUP") == 0)
+        if(strcmp(line.contents, "END_GROUP") == 0) {
+            if(in_body == 1)
+                common_parse_add_body(input, section, body_start, line_index);
+
             break;
+        }
 
         /* Start a new section, or use an existing one. */
         if(strncmp(line.contents, "START_APPEND_TO", strlen("START_APPEND_TO")) == 0) {
@@ -633,19 +1022,20 @@ void common_parse_appends(struct CStrings lines, struct Sections *array, int sta
             LIBERROR_INIT(search);
 
             in_body = 1; 
+            body_start = line_index + 1;
 
             /* If the section already exists, we should use the existing one. */
-            search.name.contents = strchr(line.contents, ' ') + 1;
+            search.name = common_intern(strchr(line.contents, ' ') + 1);
             exists = carray_find(array, search, exists, SECTION);
 
             if(exists == -1) {
                 struct Section new_section;
 
-                new_section.name = cstring_init(""); 
-                new_section.body = cstring_init(""); 
+                LIBERROR_INIT(new_section);
+                new_section.body = carray_init(new_section.body, CSTRING_VIEW);
 
                 /* All we can know from this line is the name of the section */
-                cstring_concats(&(new_section.name), strchr(line.contents, ' ') + 1);
+                new_section.name = search.name;
 
                 carray_append(array, new_section, SECTION);
                 section = array->contents + (carray_length(array) - 1);
@@ -658,27 +1048,24 @@ void common_parse_appends(struct CStrings lines, struct Sections *array, int sta
 
         /* Stop when the line is the end of a group */
         if(strcmp(line.contents, "END_APPEND_TO") == 0) {
+            common_parse_add_body(input, section, body_start, line_index);
             in_body = 0;
 
             continue;
         }
-
-        if(in_body == 0)
-            continue;
-
-        /* Construct the body */
-        cstring_concats(&(section->body), line.contents);
-        cstring_concats(&(section->body), "\n");
     }
 }
 
-void common_parse_references(struct CStrings lines, struct References *array, int start_index) {
+void common_parse_references(struct CommonParseInput input, struct References *array, int start_index) {
     int line_index = 0;
+    struct CStrings lines;
 
     VERIFY_CARRAY(array);
-    VERIFY_CARRAY(&lines);
+    VERIFY_CARRAY(input.lines);
     LIBERROR_IS_NEGATIVE(start_index);
 
+    lines = *input.lines;
+
     for(line_index = start_index; line_index < carray_length(&lines); line_index++) {
         struct CString line; 
         struct Reference reference;
@@ -699,11 +1086,8 @@ void common_parse_references(struct CStrings lines, struct References *array, in
         LIBERROR_OUT_OF_BOUNDS(line_index + 1, carray_length(&lines));
 
         /* Add a new reference */
-        reference.name = cstring_init("");
-        reference.category = cstring_init("");
-
-        cstring_concat(&(reference.name), lines.contents[line_index + 1]);
-        cstring_concat(&(reference.category), lines.contents[line_index + 2]);
+        reference.name = common_intern(lines.contents[line_index + 1].contents);
+        reference.category = common_intern(lines.contents[line_index + 2].contents);
 
         carray_append(array, reference, REFERENCE);
     }
@@ -740,127 +1124,448 @@ int common_parse_count_types(struct Embeds array, int type) {
 }
 
 /*
- * ========================
- * # Formatting functions #
- * ========================
+ * ====================
+ * # Embed databases  #
+ * ====================
 */
-struct CString *common_parse_format_embeds(struct Embeds embeds, struct EmbedRequests requests, struct CString *embed_location) {
-    int type_id = 0;
+static unsigned long common_parse_hash_name(const char *name, int length) {
+    int index = 0;
+    unsigned long hash = 2166136261UL;
+
+    for(index = 0; index < length; index++) {
+        hash ^= (unsigned char) name[index];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+/* Determine if an array has an embed with a name */
+static int common_parse_has_embed(struct Embeds array, int name) {
     int embed_index = 0;
-    struct Embeds *filtered_embeds = NULL;
-    struct Embeds *merged_embeds = NULL;
 
-    filtered_embeds = carray_init(filtered_embeds, EMBED);
-    merged_embeds = carray_init(merged_embeds, EMBED);
+    for(embed_index = 0; embed_index < carray_length(&array); embed_index++) {
+        if(array.contents[embed_index].name == name)
+            return 1;
+    }
 
-    /* Fill up the embed bodies with the bodies of all the requested embeds,
-     * ordered by the types. */
-    for(type_id = 0; type_id < common_parse_highest_type(embeds) + 1; type_id++) {
-        /* For each embed, if its of the type we expect, and is requested, add it. */
-        for(embed_index = 0; embed_index < carray_length(&embeds); embed_index++) {
-            int requested_index = -1;
-            struct Embed new_embed;
+    return 0;
+}
 
-            /* Not the type we're looking for */
-            if(embeds.contents[embed_index].type != type_id)
-                continue;
+int common_parse_load_embed_database(struct CommonEmbedDatabase *database, const char *path) {
+    long table_length = 0;
+    long header_length = (long) strlen(COMMON_PARSE_EMBEDS_MAGIC) + (long) sizeof(int) * 2;
+    FILE *database_file = NULL;
 
-            requested_index = carray_find(&requests, embeds.contents[embed_index].name.contents, requested_index, EMBED_REQUEST);
+    LIBERROR_IS_NULL(database);
+    LIBERROR_IS_NULL(path);
 
-            /* This embed was not requested. */
-            if(requested_index == -1)
-                continue;
+    database_file = fopen(path, "rb");
+    LIBERROR_FILE_OPEN_FAILURE(database_file, path);
+    LIBERROR_INIT(*database);
 
-            /* Duplicate the embed with the comment removed if needed.
-             * The initialization of the embed name is TECHNICALLY
-             * unnecessary, it just exists so we do not attempt to
-             * free NULL. */
-            new_embed.name = cstring_init("");
-            new_embed.body = cstring_init("");
-            new_embed.type = embeds.contents[embed_index].type;
-
-            if(requests.contents[requested_index].allow_comment == 0) {
-                cstring_concats(&(new_embed.body), strchr(embeds.contents[embed_index].body.contents, '\n') + 1);
-                new_embed.has_comment = 0;
-            } else {
-                cstring_concat(&(new_embed.body), embeds.contents[embed_index].body);
-                new_embed.has_comment = 1;
+#ifdef EMBED_DATABASE_MAPPED
+    {
+        struct stat database_stat;
+
+        if(fstat(fileno(database_file), &database_stat) == 0 && database_stat.st_size > 0) {
+            void *mapping = mmap(NULL, (size_t) database_stat.st_size, PROT_READ, MAP_PRIVATE, fileno(database_file), 0);
+
+            if(mapping != MAP_FAILED) {
+                database->contents = mapping;
+                database->length = (long) database_stat.st_size;
+                database->mapped = 1;
             }
+        }
+    }
+#endif
+
+    if(database->mapped == 0) {
+        struct CString text;
+
+        common_parse_read_text(&text, database_file);
+        database->contents = text.contents;
+        database->length = text.length;
+    }
+
+    fclose(database_file);
+
+    if(database->length < header_length
+       || memcmp(database->contents, COMMON_PARSE_EMBEDS_MAGIC, strlen(COMMON_PARSE_EMBEDS_MAGIC)) != 0) {
+        common_parse_free_embed_database(*database);
+
+        return 0;
+    }
+
+    memcpy(&(database->bucket_count), database->contents + strlen(COMMON_PARSE_EMBEDS_MAGIC), sizeof(int));
+    memcpy(&(database->record_count), database->contents + strlen(COMMON_PARSE_EMBEDS_MAGIC) + sizeof(int), sizeof(int));
+    table_length = (long) database->bucket_count * (long) sizeof(int)
+                   + (long) database->record_count * (long) sizeof(struct CommonEmbedRecord);
+
+    /* The buckets and records must fit, but the names and bodies are
+     * only checked when they are looked at */
+    if(database->bucket_count <= 0 || (database->bucket_count & (database->bucket_count - 1)) != 0
+       || database->record_count < 0 || database->length - header_length < table_length) {
+        common_parse_free_embed_database(*database);
+
+        return 0;
+    }
+
+    database->buckets = (const int *) (database->contents + header_length);
+    database->records = (const struct CommonEmbedRecord *) (database->buckets + database->bucket_count);
+
+    return 1;
+}
+
+void common_parse_free_embed_database(struct CommonEmbedDatabase database) {
+#ifdef EMBED_DATABASE_MAPPED
+    if(database.mapped == 1) {
+        munmap(database.contents, (size_t) database.length);
+
+        return;
+    }
+#endif
+
+    free(database.contents);
+}
+
+/* Determine if a run of a database is inside of it, with a NUL after */
+static int common_parse_database_holds(const struct CommonEmbedDatabase *database, int offset, int length) {
+    if(offset < 0 || length < 0 || (long) offset + length >= database->length)
+        return 0;
+
+    return database->contents[offset + length] == '\0';
+}
+
+int common_parse_find_database_embeds(const struct CommonEmbedDatabase *database, int name, struct Embeds *array) {
+    int found = 0;
+    int visited = 0;
+    int record_index = 0;
+    const char *name_string = common_intern_string(name);
+    int name_length = common_intern_string_length(name);
+
+    LIBERROR_IS_NULL(database);
+
+    record_index = database->buckets[common_parse_hash_name(name_string, name_length) & (unsigned long) (database->bucket_count - 1)];
+
+    /* A chain can be no longer than the database, even if it is broken */
+    while(record_index >= 0 && record_index < database->record_count && visited < database->record_count) {
+        struct Embed embed;
+        struct CommonEmbedRecord record = database->records[record_index];
+
+        visited++;
+        record_index = record.next;
+
+        if(record.name_length != name_length || common_parse_database_holds(database, record.name_offset, record.name_length) == 0)
+            continue;
+
+        if(memcmp(database->contents + record.name_offset, name_string, (size_t) name_length) != 0)
+            continue;
+
+        if(common_parse_database_holds(database, record.body_offset, record.body_length) == 0)
+            continue;
+
+        found++;
+
+        if(array == NULL)
+            continue;
+
+        LIBERROR_INIT(embed);
+        embed.type = record.type;
+        embed.name = name;
+        embed.body.contents = database->contents + record.body_offset;
+        embed.body.length = record.body_length;
+        embed.uncommented = common_parse_uncomment(embed.body);
+
+        carray_append(array, embed, EMBED);
+    }
+
+    return found;
+}
+
+/* Add the first embed of each name to an array, in the order given.
+ * The names are looked up in a table of their IDs, since an input can
+ * have far too many embeds to compare each against every other. */
+static void common_parse_add_first_embeds(struct Embeds embeds, struct Embeds *array) {
+    int slot = 0;
+    int embed_index = 0;
+    int table_size = 1;
+    int *table = NULL;
+
+    while(table_size < carray_length(&embeds) * 2) {
+        table_size *= 2;
+    }
+
+    table = malloc(sizeof(*table) * (size_t) table_size);
+
+    for(slot = 0; slot < table_size; slot++) {
+        table[slot] = -1;
+    }
+
+    for(embed_index = 0; embed_index < carray_length(&embeds); embed_index++) {
+        int name = embeds.contents[embed_index].name;
+
+        slot = name & (table_size - 1);
 
-            carray_append(filtered_embeds, new_embed, EMBED);
+        while(table[slot] != -1 && table[slot] != name) {
+            slot = (slot + 1) & (table_size - 1);
         }
+
+        if(table[slot] == name)
+            continue;
+
+        table[slot] = name;
+        carray_append(array, embeds.contents[embed_index], EMBED);
     }
 
-    /* Merge the uncommented types, then merge the commented ones */
-    for(type_id = 0; type_id < common_parse_highest_type(*filtered_embeds) + 1; type_id++) {
-        int commented_embeds = 0;
-        struct Embed commented;
-        struct Embed uncommented;
+    free(table);
+}
+
+/* Add bytes that may contain NULs to the contents of a database */
+static void common_parse_add_database_bytes(struct CString *contents, const void *bytes, int length) {
+    struct CStringView view;
+
+    view.contents = bytes;
+    view.length = length;
+
+    common_parse_concat_view(contents, view);
+}
 
-        /* Do not try to initialize new bodies for types with no embeds in it */
-        if(common_parse_count_types(embeds, type_id) == 0)
+/*
+ * The whole database is laid out in memory before the file is opened,
+ * since the previous database could be mapped from the same file, and
+ * its embeds are only read while it is laid out.
+*/
+void common_parse_write_embed_database(struct Embeds embeds, const struct CommonEmbedDatabase *previous, const char *path) {
+    int record_index = 0;
+    int bucket_count = 1;
+    int data_offset = 0;
+    int *buckets = NULL;
+    FILE *database_file = NULL;
+    struct Embeds *stored = NULL;
+    struct CommonEmbedRecord *records = NULL;
+    struct CString contents = cstring_init("");
+
+    LIBERROR_IS_NULL(path);
+
+    stored = carray_init(stored, EMBED);
+    common_parse_add_first_embeds(embeds, stored);
+
+    /* Keep the previous embeds that were not replaced */
+    for(record_index = 0; previous != NULL && record_index < previous->record_count; record_index++) {
+        int name = 0;
+        struct CommonEmbedRecord record = previous->records[record_index];
+
+        if(common_parse_database_holds(previous, record.name_offset, record.name_length) == 0)
             continue;
 
-        LIBERROR_INIT(commented);
-        LIBERROR_INIT(uncommented);
+        name = common_intern_length(previous->contents + record.name_offset, record.name_length);
 
-        commented.name = cstring_init("");
-        commented.body = cstring_init("");
-        commented.has_comment = 1;
+        /* Either the name has a new embed, or every embed of the
+         * previous database with the name was already added */
+        if(common_parse_has_embed(*stored, name) == 1)
+            continue;
 
-        uncommented.name = cstring_init("");
-        uncommented.body = cstring_init("");
-        uncommented.has_comment = 0;
+        common_parse_find_database_embeds(previous, name, stored);
+    }
 
-        /* Add the uncommented and commented requested embeds that match this type */
-        for(embed_index = 0; embed_index < carray_length(filtered_embeds); embed_index++) {
-            if(filtered_embeds->contents[embed_index].type != type_id)
-                continue;
+    while(bucket_count < carray_length(stored) * 2) {
+        bucket_count *= 2;
+    }
 
-            if(filtered_embeds->contents[embed_index].has_comment == 1) {
-                /* There was a commented embed before us, so add a new line */
-                if(commented_embeds > 0)
-                    cstring_concats(&commented.body, "\n");
+    buckets = malloc(sizeof(*buckets) * (size_t) bucket_count);
+    records = malloc(sizeof(*records) * (size_t) (carray_length(stored) + 1));
+    data_offset = (int) strlen(COMMON_PARSE_EMBEDS_MAGIC) + (int) sizeof(int) * 2 + (int) sizeof(*buckets) * bucket_count
+                  + (int) sizeof(*records) * carray_length(stored);
 
-                cstring_concats(&commented.body, filtered_embeds->contents[embed_index].body.contents);
-                commented_embeds++;
-            } else if(filtered_embeds->contents[embed_index].has_comment == 0) {
-                cstring_concats(&uncommented.body, filtered_embeds->contents[embed_index].body.contents);
-            } else {
-                fprintf(LIBERROR_STREAM, "Should not get here (%s:%i)\n", __FILE__, __LINE__); 
-                abort();
-            }
-            
+    for(record_index = 0; record_index < bucket_count; record_index++) {
+        buckets[record_index] = -1;
+    }
+
+    /* Chain the embeds from the last, so each chain is in the order the
+     * embeds were given */
+    for(record_index = carray_length(stored) - 1; record_index >= 0; record_index--) {
+        struct Embed embed = stored->contents[record_index];
+        unsigned long bucket = common_parse_hash_name(common_intern_string(embed.name), common_intern_string_length(embed.name))
+                               & (unsigned long) (bucket_count - 1);
+
+        records[record_index].type = embed.type;
+        records[record_index].next = buckets[bucket];
+        buckets[bucket] = record_index;
+    }
+
+    for(record_index = 0; record_index < carray_length(stored); record_index++) {
+        records[record_index].name_offset = data_offset;
+        records[record_index].name_length = common_intern_string_length(stored->contents[record_index].name);
+        data_offset += records[record_index].name_length + 1;
+
+        records[record_index].body_offset = data_offset;
+        records[record_index].body_length = stored->contents[record_index].body.length;
+        data_offset += records[record_index].body_length + 1;
+    }
+
+    cstring_concats(&contents, COMMON_PARSE_EMBEDS_MAGIC);
+    common_parse_add_database_bytes(&contents, &bucket_count, (int) sizeof(bucket_count));
+    common_parse_add_database_bytes(&contents, &(stored->length), (int) sizeof(stored->length));
+    common_parse_add_database_bytes(&contents, buckets, (int) sizeof(*buckets) * bucket_count);
+    common_parse_add_database_bytes(&contents, records, (int) sizeof(*records) * carray_length(stored));
+
+    for(record_index = 0; record_index < carray_length(stored); record_index++) {
+        struct Embed embed = stored->contents[record_index];
+
+        common_parse_add_database_bytes(&contents, common_intern_string(embed.name), common_intern_string_length(embed.name) + 1);
+        common_parse_concat_view(&contents, embed.body);
+        common_parse_add_database_bytes(&contents, "", 1);
+    }
+
+    database_file = fopen(path, "wb");
+    LIBERROR_FILE_OPEN_FAILURE(database_file, path);
+
+    fwrite(contents.contents, 1, (size_t) contents.length, database_file);
+    fclose(database_file);
+
+    free(buckets);
+    free(records);
+    carray_free(stored, EMBED);
+    cstring_free(contents);
+}
+
+/*
+ * ========================
+ * # Formatting functions #
+ * ========================
+*/
+/*
+ * Add the embeds of a type in a group to a synopsis, separating the group
+ * from the previous one by an empty line. Embeds with comments are each
+ * separated by an empty line too, since each comment introduces its own
+ * embed, while those without are packed together.
+*/
+static void common_parse_add_embed_group(struct CStringViews *embed_location, struct Embeds group, int type,
+                                         int separate, int *merged_count) {
+    int added = 0;
+    int embed_index = 0;
+    int group_length = 0;
+
+    for(embed_index = 0; embed_index < carray_length(&group); embed_index++) {
+        if(group.contents[embed_index].type != type)
+            continue;
+
+        if(separate == 1 && added > 0)
+            group_length++;
+
+        group_length += group.contents[embed_index].body.length;
+        added++;
+    }
+
+    /* Nothing to show for this group */
+    if(group_length == 0)
+        return;
+
+    if(*merged_count > 0) {
+        carray_append(embed_location, common_parse_view_string("\n"), CSTRING_VIEW);
+    }
+
+    added = 0;
+
+    for(embed_index = 0; embed_index < carray_length(&group); embed_index++) {
+        if(group.contents[embed_index].type != type)
             continue;
+
+        if(separate == 1 && added > 0) {
+            carray_append(embed_location, common_parse_view_string("\n"), CSTRING_VIEW);
         }
 
-        if(commented.body.length > 0) {
-            carray_append(merged_embeds, commented, EMBED); 
-        } else {
-            EMBED_FREE(commented); 
+        if(group.contents[embed_index].body.length > 0) {
+            carray_append(embed_location, group.contents[embed_index].body, CSTRING_VIEW);
         }
 
-        if(uncommented.body.length > 0) {
-            carray_append(merged_embeds, uncommented, EMBED); 
-        } else {
-            EMBED_FREE(uncommented); 
+        added++;
+    }
+
+    (*merged_count)++;
+}
+
+void common_parse_format_embeds(struct Embeds embeds, const struct CommonEmbedDatabase *database,
+                                struct EmbedRequests requests, struct CStringViews *embed_location) {
+    int type_id = 0;
+    int embed_index = 0;
+    int merged_count = 0;
+    int highest_type = 0;
+    struct Embeds *commented = NULL;
+    struct Embeds *uncommented = NULL;
+    struct Embeds *found_embeds = NULL;
+
+    VERIFY_CARRAY(embed_location);
+
+    commented = carray_init(commented, EMBED);
+    uncommented = carray_init(uncommented, EMBED);
+
+    /* Look up the requests the embeds have nothing for in the database,
+     * after the embeds given, so they are merged like any other */
+    if(database != NULL) {
+        int request_index = 0;
+
+        found_embeds = carray_init(found_embeds, EMBED);
+
+        for(embed_index = 0; embed_index < carray_length(&embeds); embed_index++) {
+            carray_append(found_embeds, embeds.contents[embed_index], EMBED);
         }
+
+        for(request_index = 0; request_index < carray_length(&requests); request_index++) {
+            if(common_parse_has_embed(*found_embeds, requests.contents[request_index].name) == 1)
+                continue;
+
+            common_parse_find_database_embeds(database, requests.contents[request_index].name, found_embeds);
+        }
+
+        embeds = *found_embeds;
     }
 
-    /* Merge the final array into a single string */
-    for(embed_index = 0; embed_index < carray_length(merged_embeds); embed_index++) {
-        cstring_concats(embed_location, merged_embeds->contents[embed_index].body.contents);
+    /* Sort the requested embeds by whether their comment is shown, using
+     * the form of the body each is requested in. Only the views are copied,
+     * never the bodies themselves. */
+    for(embed_index = 0; embed_index < carray_length(&embeds); embed_index++) {
+        int requested_index = -1;
+        struct Embed requested = embeds.contents[embed_index];
+
+        requested_index = carray_find(&requests, requested.name, requested_index, EMBED_REQUEST);
 
-        if(embed_index == (carray_length(merged_embeds) - 1))
+        /* This embed was not requested. */
+        if(requested_index == -1)
             continue;
 
-        cstring_concats(embed_location, "\n");
+        /* Only the first embed with a name is shown, as it is the one a
+         * streamed manual is written with */
+        if(common_parse_has_embed(*commented, requested.name) == 1 || common_parse_has_embed(*uncommented, requested.name) == 1)
+            continue;
+
+        if(requests.contents[requested_index].allow_comment == 1) {
+            carray_append(commented, requested, EMBED);
+
+            continue;
+        }
+
+        requested.body = requested.uncommented;
+        carray_append(uncommented, requested, EMBED);
+    }
+
+    highest_type = common_parse_highest_type(*commented);
+
+    if(common_parse_highest_type(*uncommented) > highest_type)
+        highest_type = common_parse_highest_type(*uncommented);
+
+    /* Merge the commented embeds of each type, then the uncommented ones */
+    for(type_id = 0; type_id < highest_type + 1; type_id++) {
+        common_parse_add_embed_group(embed_location, *commented, type_id, 1, &merged_count);
+        common_parse_add_embed_group(embed_location, *uncommented, type_id, 0, &merged_count);
     }
 
-    carray_free(merged_embeds, EMBED);
-    carray_free(filtered_embeds, EMBED);
+    carray_free(commented, EMBED);
+    carray_free(uncommented, EMBED);
 
-    return embed_location;
+    if(found_embeds != NULL)
+        carray_free(found_embeds, EMBED);
 }
 
 int common_parse_count_lines_between_multilines(struct CStrings lines, int index, const char *multiline) {
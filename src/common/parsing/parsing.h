@@ -38,43 +38,121 @@
 #ifndef CWARE_DOCGEN_COMMON_PARSING_H
 #define CWARE_DOCGEN_COMMON_PARSING_H
 
+/* The record an extractor writes before the tags of each file it was
+ * given, followed by the path of the file. The lines after it belong to
+ * that file, up until the next one. */
+#define COMMON_PARSE_FILE_RECORD "FILE "
+
+/* The tags which start and end a docgen block */
+#define COMMON_PARSE_BLOCK_START    "@docgen_start"
+#define COMMON_PARSE_BLOCK_END      "@docgen_end"
+
+/* Every name below is an ID from the intern table (see common/intern),
+ * so names are compared as integers. Bodies are views into the input
+ * they were parsed from, so the input must outlive them. */
 #define SECTION_TYPE    struct Section
 #define SECTION_HEAP    1
 #define SECTION_COMPARE(a, b) \
-    (strcmp((a).name.contents, (b).name.contents) == 0)
+    ((a).name == (b).name)
 
-#define SECTION_FREE(section)     \
-    cstring_free((section).name); \
-    cstring_free((section).body)
+#define SECTION_FREE(section) \
+    common_parse_free_section((section))
 
 #define EMBED_TYPE    struct Embed
 #define EMBED_HEAP    1
 #define EMBED_COMPARE(a, b) \
-    (strcmp((a).name.contents, (b).name.contents) == 0)
+    ((a).name == (b).name)
 
-#define EMBED_FREE(embed)       \
-    cstring_free((embed).name); \
-    cstring_free((embed).body)
+#define EMBED_FREE(embed)
 
 #define EMBED_REQUEST_TYPE  struct EmbedRequest
 #define EMBED_REQUEST_HEAP  1
-#define EMBED_REQUEST_FREE(request) \
-    cstring_free((request).name);
+#define EMBED_REQUEST_FREE(request)
 #define EMBED_REQUEST_COMPARE(a, b) \
-    (strcmp((a).name.contents, (b)) == 0)
+    ((a).name == (b))
 
 #define REFERENCE_TYPE  struct Reference
 #define REFERENCE_HEAP  1
-#define REFERENCE_FREE(reference)      \
-    cstring_free((reference).name);    \
-    cstring_free((reference).category)
+#define REFERENCE_FREE(reference)
+
+#define CSTRING_VIEW_TYPE   struct CStringView
+#define CSTRING_VIEW_HEAP   1
+#define CSTRING_VIEW_FREE(view)
+
+/* Lines of an input, which point into a buffer they do not own */
+#define BORROWED_CSTRING_TYPE   struct CString
+#define BORROWED_CSTRING_HEAP   1
+#define BORROWED_CSTRING_FREE(line)
+
+#define TEXT_BLOCK_TYPE struct TextBlock
+#define TEXT_BLOCK_HEAP 1
+#define TEXT_BLOCK_FREE(block)
+
+#define COMMON_PARSE_INPUT_TYPE struct CommonParseInput
+#define COMMON_PARSE_INPUT_HEAP 1
+#define COMMON_PARSE_INPUT_FREE(input) \
+    common_parse_free_input((input))
 
 struct CString;
+struct CommonErrorsLineIndex;
+
+/* A string that does not own its contents, and is not NUL terminated */
+struct CStringView {
+    const char *contents;
+    int length;
+};
+
+/* A docgen block of a text, from the start of the line with its start
+ * tag to the end of the line with its end tag. The line index is the
+ * number of lines of the text that come before it. A block that is not
+ * closed before the next one starts, or before the end of the text,
+ * runs on to the next end tag or the end. */
+struct TextBlock {
+    const char *start;
+    const char *end;
+    int line_index;
+    int closed;
+};
+
+struct TextBlocks {
+    int length;
+    int capacity;
+    struct TextBlock *contents;
+};
+
+/* A list of views, which together make up a single string */
+struct CStringViews {
+    int length;
+    int capacity;
+    struct CStringView *contents;
+};
+
+/*
+ * An entire input, read into a single buffer. The lines point into a
+ * copy of the text with each line ending replaced by a NUL, so any run
+ * of lines can also be viewed in the text, line endings included. The
+ * offset each line starts at is indexed, so the line any offset of the
+ * text is on can be found with common_errors_find_line.
+*/
+struct CommonParseInput {
+    struct CString text;
+    char *terminated;
+    struct CStrings *lines;
+    struct CommonErrorsLineIndex *line_starts;
+};
 
-/* A section name and body pair */
+struct CommonParseInputs {
+    int length;
+    int capacity;
+    struct CommonParseInput *contents;
+};
+
+/* A section name and body pair. A section's body can be made of several
+ * runs of lines (prepends, the section itself, and appends), so it is a
+ * list of views. */
 struct Section {
-    struct CString name;
-    struct CString body;
+    int name;
+    struct CStringViews *body;
 };
 
 struct Sections {
@@ -86,15 +164,13 @@ struct Sections {
 /* A parsed embed */
 struct Embed {
     int type;
-    struct CString name;
-    struct CString body;
+    int name;
+    struct CStringView body;
 
-    /* This field is only used when embeds are being filtered, so
-     * we do not need to make a new structure to hold embeds, and
-     * whether or not they have a comment, as we merge non-commented
-     * embeds of the same type and commented ones of the same type
-     * separately before merging them both. */
-    int has_comment;
+    /* The body without its comment, which is its first line. Both forms
+     * view the same text, so they are worked out once, when the embed is
+     * parsed, and every manual that requests it shares them. */
+    struct CStringView uncommented;
 };
 
 struct Embeds {
@@ -106,7 +182,7 @@ struct Embeds {
 /* Embed requests */
 struct EmbedRequest {
     int allow_comment;
-    struct CString name;
+    int name;
 };
 
 struct EmbedRequests {
@@ -115,10 +191,51 @@ struct EmbedRequests {
     struct EmbedRequest *contents;
 };
 
+/* The start of every embed database */
+#define COMMON_PARSE_EMBEDS_MAGIC   "DOCGEN EMBEDS 1\n"
+
+/* An embed as it is kept in an embed database. Offsets are from the
+ * start of the database, and next is the index of the next embed in
+ * the same bucket, or -1. */
+struct CommonEmbedRecord {
+    int name_offset;
+    int name_length;
+    int type;
+    int body_offset;
+    int body_length;
+    int next;
+};
+
+/*
+ * A database of embeds, so a manual can request an embed that was not
+ * in the input it was compiled with. It is laid out as:
+ *
+ *   COMMON_PARSE_EMBEDS_MAGIC
+ *   the number of buckets, which is a power of two
+ *   the number of embeds
+ *   for each bucket, the index of its first embed, or -1
+ *   each embed, as a struct CommonEmbedRecord
+ *   the names and bodies of the embeds, each followed by a NUL
+ *
+ * An embed is in the bucket its name hashes to, so looking one up only
+ * touches the embeds in that bucket. Numbers are stored in the byte
+ * order of the machine that wrote them, so a database is not meant to
+ * be moved between machines.
+*/
+struct CommonEmbedDatabase {
+    char *contents;
+    long length;
+    int mapped;
+    int bucket_count;
+    int record_count;
+    const int *buckets;
+    const struct CommonEmbedRecord *records;
+};
+
 /* References */
 struct Reference {
-    struct CString name;   
-    struct CString category;
+    int name;
+    int category;
 };
 
 struct References {
@@ -130,6 +247,30 @@ struct References {
 /* Read lines of a file into an array */
 int common_parse_readlines(struct CStrings *array, FILE *location);
 
+/* Read a single line of a file, without the line ending. Returns 0
+ * at the end of the file. */
+int common_parse_readline(struct CString *line, FILE *location);
+
+/* Read an entire file into a string */
+void common_parse_read_text(struct CString *text, FILE *location);
+
+/* Read an entire file into an input, and split it into lines */
+void common_parse_read_input(struct CommonParseInput *input, FILE *location);
+
+/* Split the text of an input into lines */
+void common_parse_split_input(struct CommonParseInput *input);
+
+void common_parse_free_input(struct CommonParseInput input);
+
+/* View a run of lines of an input, with their line endings */
+struct CStringView common_parse_view_lines(struct CommonParseInput input, int start_index, int end_index);
+struct CStringView common_parse_view_string(const char *string);
+int common_parse_views_length(struct CStringViews views);
+void common_parse_concat_view(struct CString *location, struct CStringView view);
+void common_parse_concat_views(struct CString *location, struct CStringViews views);
+void common_parse_add_body(struct CommonParseInput input, struct Section *section, int start_index, int end_index);
+void common_parse_free_section(struct Section section);
+
 /* Determine if a line has a tag */
 int common_parse_line_has_tag(struct CString line);
 
@@ -137,6 +278,14 @@ int common_parse_line_has_tag(struct CString line);
  * exist. */
 int common_parse_get_tag_index(struct CString line);
 
+/* Find the start of the next line between the cursor and the end of a
+ * text whose tag starts with the given tag. Returns NULL if there is
+ * none. */
+const char *common_parse_find_tag_line(const char *text, const char *cursor, const char *end, const char *tag);
+
+/* Find each docgen block of a text, without splitting it into lines */
+void common_parse_find_blocks(struct CString text, struct TextBlocks *blocks);
+
 /* This function will read the name of a tag from a line, and write it
  * into the given cstring. The name of the tag is defined as all the text
  * from the first '@' to the first non-alphabetical or underscore character.
@@ -146,15 +295,36 @@ struct CString *common_parse_read_tag(struct CString line, struct CString *locat
 /* Display the string converted to uppercase */
 void common_parse_upper_string(FILE *location, const char *string, int length);
 
-struct CString *common_parse_format_embeds(struct Embeds embeds, struct EmbedRequests requests, struct CString *embed_location);
+/* Add the embeds a manual requests to its synopsis, as views of their
+ * bodies. Requests the embeds given have nothing for are looked up in
+ * the database, if one is given. When there is more than one embed
+ * with a name, only the first is added. */
+void common_parse_format_embeds(struct Embeds embeds, const struct CommonEmbedDatabase *database,
+                                struct EmbedRequests requests, struct CStringViews *embed_location);
+
+/* Load an embed database. It is mapped into memory where that is
+ * available. Returns 0 if the file is not an embed database. */
+int common_parse_load_embed_database(struct CommonEmbedDatabase *database, const char *path);
+void common_parse_free_embed_database(struct CommonEmbedDatabase database);
+
+/* Write the embeds given into an embed database, along with the embeds
+ * of a previous database, if one is given, whose names are not given a
+ * new embed. Only the first embed given with a name is written. The
+ * previous database can be the file being written. */
+void common_parse_write_embed_database(struct Embeds embeds, const struct CommonEmbedDatabase *previous, const char *path);
+
+/* Add the embeds with a name in a database to an array, if one is
+ * given, in the order they were written. Returns the number of embeds
+ * with the name. */
+int common_parse_find_database_embeds(const struct CommonEmbedDatabase *database, int name, struct Embeds *array);
 int common_parse_count_types(struct Embeds array, int type);
 int common_parse_highest_type(struct Embeds array);
-void common_parse_references(struct CStrings lines, struct References *array, int start_index);
-void common_parse_appends(struct CStrings lines, struct Sections *array, int start_index);
-void common_parse_sections(struct CStrings lines, struct Sections *array, int start_index);
-void common_parse_prepends(struct CStrings lines, struct Sections *array, int start_index);
-void common_parse_embed_requests(struct CStrings lines, struct EmbedRequests *array, int start_index);
-void common_parse_embeds(struct CStrings lines, struct Embeds *array);
+void common_parse_references(struct CommonParseInput input, struct References *array, int start_index);
+void common_parse_appends(struct CommonParseInput input, struct Sections *array, int start_index);
+void common_parse_sections(struct CommonParseInput input, struct Sections *array, int start_index);
+void common_parse_prepends(struct CommonParseInput input, struct Sections *array, int start_index);
+void common_parse_embed_requests(struct CommonParseInput input, struct EmbedRequests *array, int start_index);
+void common_parse_embeds(struct CommonParseInput input, struct Embeds *array);
 int common_parse_count_lines_between_multilines(struct CStrings lines, int index, const char *mutliline);
 
 #endif
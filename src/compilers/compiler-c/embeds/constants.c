@@ -44,6 +44,7 @@
 #include "../../../docgen.h"
 
 #include "../main.h"
+#include "embeds.h"
 #include "../../../common/parsing/parsing.h"
 
 void compile_constant_embed(struct ProgramState *state, int docgen_start_index) {
@@ -108,6 +109,10 @@ void compile_constant_embeds(struct ProgramState *state) {
         if(strcmp(strchr(line.contents, ' ') + 1, "constant") != 0)
             continue;
 
+        /* Nothing requests this embed, so there is no use in compiling it */
+        if(embed_is_requested(state, line_index) == 0)
+            continue;
+
         line = state->input_lines->contents[line_index + 2];
         common_parse_read_tag(line, &(state->tag_name)); 
 
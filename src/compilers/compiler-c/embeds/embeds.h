@@ -46,4 +46,19 @@ void compile_structure_embeds(struct ProgramState *state);
 
 void compile_macro_function_embeds(struct ProgramState *state);
 
+/* Select the groups with the names given, separated by commas, after
+ * which only those groups are compiled */
+void select_groups(struct ProgramState *state, const char *names);
+
+/* Whether the docgen block starting at an index makes a group */
+int group_is_selected(struct ProgramState *state, int docgen_start_index);
+
+/* Collect the name of every embed requested in the input, after which
+ * only those embeds are compiled */
+void collect_embed_requests(struct ProgramState *state);
+
+/* Whether the embed of the docgen block starting at an index should be
+ * compiled */
+int embed_is_requested(struct ProgramState *state, int docgen_start_index);
+
 #endif
@@ -0,0 +1,183 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* 
+ * Implementations of the collection of embed requests, so only the embeds
+ * that are requested have to be compiled, and of the selection of groups,
+ * so only some of them have to be compiled.
+*/
+
+#include <stdio.h>
+
+#include "../../../docgen.h"
+#include "../../../common/intern/intern.h"
+
+#include "../main.h"
+#include "embeds.h"
+#include "../../../common/parsing/parsing.h"
+
+/* Mark an embed as requested by interning its name */
+void request_embed(const char *name) {
+    LIBERROR_IS_NULL(name);
+
+    common_intern_add_flags(common_intern(name), EMBED_REQUESTED);
+}
+
+/* Retrieve the flags of the name of the docgen block starting at an index.
+ * Blocks that are cut short, or have no name, have none. */
+static int block_name_flags(struct ProgramState *state, int docgen_start_index) {
+    int name_id = 0;
+    const char *name = NULL;
+
+    if(docgen_start_index < 0 || docgen_start_index + 2 >= carray_length(state->input_lines))
+        return 0;
+
+    name = strchr(state->input_lines->contents[docgen_start_index + 2].contents, ' ');
+
+    if(name == NULL)
+        return 0;
+
+    name_id = common_intern_find(name + 1);
+
+    if(name_id == COMMON_INTERN_MISSING)
+        return 0;
+
+    return common_intern_flags(name_id);
+}
+
+void select_groups(struct ProgramState *state, const char *names) {
+    const char *cursor = names;
+
+    VERIFY_PROGRAM_STATE(state);
+    LIBERROR_IS_NULL(names);
+
+    while(*cursor != '\0') {
+        int length = (int) strcspn(cursor, ",");
+
+        if(length > 0)
+            common_intern_add_flags(common_intern_length(cursor, length), GROUP_SELECTED);
+
+        cursor += length;
+
+        if(*cursor == ',')
+            cursor++;
+    }
+
+    state->select_groups = 1;
+}
+
+int group_is_selected(struct ProgramState *state, int docgen_start_index) {
+    VERIFY_PROGRAM_STATE(state);
+
+    if(state->select_groups == 0)
+        return 1;
+
+    return (block_name_flags(state, docgen_start_index) & GROUP_SELECTED) != 0;
+}
+
+/*
+ * Collect the name of every embed that is requested anywhere in the input,
+ * before any of it is compiled, so only those embeds have to be compiled.
+ * Embeds are requested by "@embed" tags, and functions and macro functions
+ * implicitly request their own. When only some groups are selected, only
+ * their requests count. This runs before the input is validated, so lines
+ * that are not well formed are skipped, and left for validation to report.
+ * At worst, this collects a name that nothing really requests, which only
+ * means compiling an embed that would have been compiled anyway.
+*/
+void collect_embed_requests(struct ProgramState *state) {
+    int line_index = 0;
+    int in_selected = 0;
+
+    VERIFY_PROGRAM_STATE(state);
+
+    for(line_index = 0; line_index < carray_length(state->input_lines); line_index++) {
+        const char *type = NULL;
+        const char *name = NULL;
+        struct CString line = state->input_lines->contents[line_index];
+
+        if(strchr(line.contents, '@') == NULL)
+            continue;
+
+        common_parse_read_tag(line, &(state->tag_name));
+
+        if(strcmp(state->tag_name.contents, DOCGEN_END) == 0) {
+            in_selected = 0;
+
+            continue;
+        }
+
+        if(strcmp(state->tag_name.contents, "@embed") == 0) {
+            name = strchr(line.contents, ' ');
+
+            if(name != NULL && (in_selected == 1 || state->select_groups == 0))
+                request_embed(name + 1);
+
+            continue;
+        }
+
+        if(strcmp(state->tag_name.contents, DOCGEN_START) != 0)
+            continue;
+
+        in_selected = group_is_selected(state, line_index);
+
+        if(in_selected == 0 || line_index + 2 >= carray_length(state->input_lines))
+            continue;
+
+        type = strchr(state->input_lines->contents[line_index + 1].contents, ' ');
+        name = strchr(state->input_lines->contents[line_index + 2].contents, ' ');
+
+        if(type == NULL || name == NULL)
+            continue;
+
+        if(strcmp(type + 1, "function") != 0 && strcmp(type + 1, "macro_function") != 0)
+            continue;
+
+        request_embed(name + 1);
+    }
+
+    state->demand_embeds = 1;
+}
+
+int embed_is_requested(struct ProgramState *state, int docgen_start_index) {
+    VERIFY_PROGRAM_STATE(state);
+
+    if(state->demand_embeds == 0)
+        return 1;
+
+    return (block_name_flags(state, docgen_start_index) & EMBED_REQUESTED) != 0;
+}
@@ -38,6 +38,20 @@
 #ifndef CWARE_DOCGEN_COMPILER_C_H
 #define CWARE_DOCGEN_COMPILER_C_H
 
+#include <setjmp.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+
+#define COMPILE_THREADED 1
+#endif
+
+/* Each stage of the pipeline runs on a thread of its own, and passes
+ * blocks to the next through a ring built on GCC atomics */
+#if defined(COMPILE_THREADED) && defined(__GNUC__)
+#define COMPILE_PIPELINED 1
+#endif
+
 /* Configuration */
 #define SPACING_PER_TAB 4
 
@@ -45,6 +59,18 @@
 #define DOCGEN_START    "@docgen_start"
 #define DOCGEN_END      "@docgen_end"
 
+/* Tag kinds, attached to each known tag in the intern table */
+#define TAG_MULTILINE   1
+#define TAG_FIELD       2
+#define TAG_GROUP       4
+
+/* Attached to the name of each embed that is requested, in the intern
+ * table, when only requested embeds are compiled */
+#define EMBED_REQUESTED 8
+
+/* Attached to the name of each group selected with --only */
+#define GROUP_SELECTED  16
+
 /* Exit codes */
 #define EXIT_UNCLOSED_DOCGEN            2
 #define EXIT_INCOMPLETE_LINE_NUMBER     3
@@ -71,6 +97,10 @@
     VERIFY_CSTRING(&((state)->tag_name));          \
     VERIFY_CARRAY((state)->input_lines)
 
+#define LINE_NUMBER_TYPE int
+#define LINE_NUMBER_HEAP 1
+#define LINE_NUMBER_FREE(value)
+
 #define FUNCTION_PARAMETER_TYPE struct FunctionParameter
 #define FUNCTION_PARAMETER_HEAP 1
 #define FUNCTION_PARAMETER_FREE(value) \
@@ -132,6 +162,32 @@ struct MacroFunction {
     struct CString return_description;
 };
 
+/* A tag, and the kinds it belongs to */
+struct TagKind {
+    const char *name;
+    int flags;
+};
+
+/* The command line arguments for the program */
+struct ProgramArguments {
+    int jobs;
+    int stream;
+    int pipeline;
+    int check;
+    int demand;
+    char *only;
+    char *source;
+    int file_count;
+    char **files;
+};
+
+/* The line number in the source file of each line of input */
+struct LineNumbers {
+    int length;
+    int capacity;
+    int *contents;
+};
+
 /* Container of state for the program. Contains common
  * data for memory reusage. */
 struct ProgramState {
@@ -140,6 +196,94 @@ struct ProgramState {
     struct CString tag_name;
     struct CStrings *input_lines;
     FILE *compilation_output;
+
+    /* The number of lines of input that came before the first
+     * line in input_lines. Only non-zero when streaming. */
+    int line_offset;
+
+    /* The line number in the source file of each line in input_lines,
+     * when the tags were read straight from a source file, or when the
+     * input has FILE records. NULL otherwise. */
+    struct LineNumbers *line_numbers;
+
+    /* Whether the input was read straight from a source file, in which
+     * case its lines have no line number prefix. */
+    int from_source;
+
+    /* Whether only the embeds that something requests are compiled */
+    int demand_embeds;
+
+    /* Whether only the groups selected with --only are compiled */
+    int select_groups;
+
+    /* The file the input came from, if it is known, and where a line
+     * is in it, for diagnostics. */
+    struct CString file_name;
+    struct CString location;
+
+    /* Where errors in the input are reported, which is LIBERROR_STREAM
+     * when NULL, and where to jump back to after reporting one, instead
+     * of exiting, along with the code it would have exited with. */
+    FILE *error_output;
+    jmp_buf *recovery;
+    int error_code;
+};
+
+/* A range of docgen blocks compiled on its own thread. Each job has
+ * its own scratch space, and writes the output of each compilation
+ * pass into its own temporary file. */
+struct CompileJob {
+    struct ProgramState state;
+    struct CStrings lines;
+    FILE **pass_outputs;
 };
 
+/* How many blocks can be waiting between two stages of the pipeline
+ * before the stage feeding them has to wait. A power of two, so the
+ * counters of a ring can wrap around without skipping a slot. */
+#define PIPELINE_RING_SIZE 64
+
+/* A docgen block on its way through the pipeline. It starts out as the
+ * lines of the block, and once compiled, also holds its output. The
+ * last block of the input has no lines, and marks its end. A block
+ * with an error holds the error instead of its output, along with the
+ * code to exit with, and nothing after it is compiled. */
+struct PipelineBlock {
+    struct CStrings *lines;
+    struct LineNumbers *line_numbers;
+    struct CString file_name;
+    char *output;
+    long output_length;
+    int error_code;
+    int last;
+};
+
+#ifdef COMPILE_PIPELINED
+/* A ring of blocks passed from one stage of the pipeline to the next.
+ * The stage before it is the only one to move the tail, and the stage
+ * after it is the only one to move the head, so neither needs a lock
+ * to do so. A stage which finds the ring full, or empty, marks itself
+ * as waiting and sleeps on the condition variable until the other stage
+ * moves its end of the ring and wakes it up. */
+struct PipelineRing {
+    unsigned long head;
+    unsigned long tail;
+    struct PipelineBlock *slots[PIPELINE_RING_SIZE];
+    int pusher_waiting;
+    int popper_waiting;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+/* The stages of the pipeline, and the rings between them */
+struct Pipeline {
+    FILE *input;
+    const char *source;
+    struct ProgramState state;
+    struct PipelineRing extracted;
+    struct PipelineRing compiled;
+};
+
+#endif
+
 #endif
@@ -43,9 +43,21 @@
 
 #include "../../../docgen.h"
 
+#include "../../../common/intern/intern.h"
+
 #include "../main.h"
 #include "../../../common/parsing/parsing.h"
 
+/* Whether the embed with a name was requested, once requests are collected */
+static int embed_is_requested(const char *name) {
+    int name_id = common_intern_find(name);
+
+    if(name_id == COMMON_INTERN_MISSING)
+        return 0;
+
+    return (common_intern_flags(name_id) & EMBED_REQUESTED) != 0;
+}
+
 void compile_macro_embed(struct ProgramState *state, int docgen_start_index) {
     int line_index = docgen_start_index;
 
@@ -128,6 +140,10 @@ void compile_macro_embeds(struct ProgramState *state) {
         line = state->input_lines->contents[line_index + 2];
         common_parse_read_tag(line, &(state->tag_name)); 
 
+        /* Nothing requests this embed, so there is no use in compiling it */
+        if(state->demand_embeds == 1 && embed_is_requested(strchr(line.contents, ' ') + 1) == 0)
+            continue;
+
         fprintf(state->compilation_output, "%s", "START_EMBED ");
         fprintf(state->compilation_output, "%s", strchr(line.contents, ' ') + 1);
         fprintf(state->compilation_output, "%c", '\n');
@@ -102,6 +102,8 @@
  * where x is the rule number.
 */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <ctype.h>
 #include <stdarg.h>
 #include <string.h>
@@ -109,90 +111,155 @@
 
 #include "../../docgen.h"
 #include "../../common/errors/errors.h"
+#include "../../common/intern/intern.h"
 #include "../../common/parsing/parsing.h"
 
 #include "main.h"
 #include "embeds/embeds.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+
+#define COMPILE_THREADED 1
+#endif
+
+/* The help message, a line at a time, which keeps each string within
+ * the length C89 compilers have to support */
+static const char *help_message[] = {
+    "docgen-compiler-m4 [ --stream | -S ] [ --source FILE | -s FILE ] [ --jobs JOBS | -j JOBS ]\n",
+    "                  [ --check | -c ] [ --demand | -d ] [ --only NAMES | -o NAMES ] [ FILE... ]\n",
+    "Compile extracted docgen tags into input for a backend.\n",
+    "\n",
+    "Optional arguments:\n",
+    "   --stream, -S                validate and compile each docgen block as soon as it ends\n",
+    "   --source, -s FILE           read the tags straight from a source file, rather than\n",
+    "                               from the output of an extractor on the stdin\n",
+    "   --jobs, -j JOBS             compile the docgen blocks on this many threads. defaults to 1\n",
+    "   --check, -c                 only validate the tags of each source FILE given, or of the\n",
+    "                               stdin if there are none, without compiling anything\n",
+    "   --demand, -d                only compile the embeds that are requested by an @embed\n",
+    "                               tag, or by a macro\n",
+    "   --only, -o NAMES            only compile the groups with these names, separated by commas,\n",
+    "                               and the embeds they request. other blocks are not validated\n",
+    NULL
+};
+
 /* 
  * =========================================
  *             Tag type checking
  * =========================================
 */
-int is_multiline(struct CString tag) {
-    VERIFY_CSTRING(&tag);
+/* Every tag this compiler knows about, and what kind of tag it is */
+struct TagKind tag_kinds[] = {
+    {"@description", TAG_MULTILINE},
+    {"@return_value", TAG_MULTILINE},
+    {"@synopsis", TAG_MULTILINE},
+    {"@notes", TAG_MULTILINE},
+    {"@examples", TAG_MULTILINE},
+    {"@value", TAG_FIELD},
+    {"@reference", TAG_FIELD},
+    {"@error", TAG_FIELD},
+    {"@param", TAG_FIELD},
+    {"@embed", TAG_FIELD},
+    {"@include", TAG_FIELD},
+    {"@type", TAG_FIELD},
+    {"@name", TAG_FIELD},
+    {"@show_brief", TAG_FIELD},
+    {"@brief", TAG_FIELD},
+    {"@docgen_start", TAG_GROUP},
+    {"@docgen_end", TAG_GROUP},
+    {NULL, 0}
+};
+
+/* Intern each known tag, and attach its kind to it, so checking a
+ * tag's kind is a single lookup rather than a comparison against
+ * every known tag. */
+void register_tags(void) {
+    int tag_index = 0;
+
+    for(tag_index = 0; tag_kinds[tag_index].name != NULL; tag_index++) {
+        common_intern_add_flags(common_intern(tag_kinds[tag_index].name), tag_kinds[tag_index].flags);
+    }
+}
 
-    if(strcmp(tag.contents, "@description") == 0)
-        return 1;
+int tag_flags(struct CString tag) {
+    int tag_id = 0;
 
-    if(strcmp(tag.contents, "@return_value") == 0)
-        return 1;
+    VERIFY_CSTRING(&tag);
 
-    if(strcmp(tag.contents, "@synopsis") == 0)
-        return 1;
+    tag_id = common_intern_find(tag.contents);
 
-    if(strcmp(tag.contents, "@notes") == 0)
-        return 1;
+    if(tag_id == COMMON_INTERN_MISSING)
+        return 0;
 
-    if(strcmp(tag.contents, "@examples") == 0)
-        return 1;
+    return common_intern_flags(tag_id);
+}
 
-    return 0;
+int is_multiline(struct CString tag) {
+    return (tag_flags(tag) & TAG_MULTILINE) != 0;
 }
 
 int is_field(struct CString tag) {
-    VERIFY_CSTRING(&tag);
+    return (tag_flags(tag) & TAG_FIELD) != 0;
+}
 
-    if(strcmp(tag.contents, "@value") == 0)
-        return 1;
+int is_group(struct CString tag) {
+    return (tag_flags(tag) & TAG_GROUP) != 0;
+}
 
-    if(strcmp(tag.contents, "@reference") == 0)
-        return 1;
+/*
+ * ========================
+ * # Information retrival #
+ * ========================
+*/
 
-    if(strcmp(tag.contents, "@error") == 0)
-        return 1;
+/* Convert an index into the input lines into the line number the user
+ * would see in the input, accounting for lines that were already
+ * streamed through and released. */
+int get_line_number(struct ProgramState *state, int line_index) {
+    LIBERROR_IS_NEGATIVE(line_index);
 
-    if(strcmp(tag.contents, "@param") == 0)
-        return 1;
+    if(state->line_numbers != NULL) {
+        LIBERROR_OUT_OF_BOUNDS(line_index, carray_length(state->line_numbers));
 
-    if(strcmp(tag.contents, "@embed") == 0)
-        return 1;
+        return state->line_numbers->contents[line_index];
+    }
 
-    if(strcmp(tag.contents, "@include") == 0)
-        return 1;
+    return state->line_offset + line_index + 1;
+}
 
-    if(strcmp(tag.contents, "@type") == 0)
-        return 1;
+/* Describe where a line of input came from for a diagnostic. This is
+ * just the line number, unless the file it came from is known. */
+const char *get_location(struct ProgramState *state, int line_index) {
+    char line_number[32];
 
-    if(strcmp(tag.contents, "@name") == 0)
-        return 1;
+    sprintf(line_number, "%i", get_line_number(state, line_index));
+    cstring_reset(&(state->location));
 
-    if(strcmp(tag.contents, "@show_brief") == 0)
-        return 1;
+    if(state->file_name.length != 0) {
+        cstring_concat(&(state->location), state->file_name);
+        cstring_concats(&(state->location), ":");
+    }
 
-    if(strcmp(tag.contents, "@brief") == 0)
-        return 1;
+    cstring_concats(&(state->location), line_number);
 
-    return 0;
+    return state->location.contents;
 }
 
-int is_group(struct CString tag) {
-    VERIFY_CSTRING(&tag);
-
-    if(strcmp(tag.contents, "@docgen_start") == 0)
-        return 1;
+/* Whether a line of input starts the tags of another file */
+int is_file_record(struct CString line) {
+    return strncmp(line.contents, COMMON_PARSE_FILE_RECORD, strlen(COMMON_PARSE_FILE_RECORD)) == 0;
+}
 
-    if(strcmp(tag.contents, "@docgen_end") == 0)
-        return 1;
+/* The line number in the source file a line of input was extracted
+ * from, or the fallback if the line does not start with one. */
+int extracted_line_number(struct CString line, int fallback) {
+    if(isdigit((unsigned char) line.contents[0]) == 0)
+        return fallback;
 
-    return 0;
+    return atoi(line.contents);
 }
 
-/*
- * ========================
- * # Information retrival #
- * ========================
-*/
 int has_errors(struct ProgramState *state, int start_index) {
     int line_index = 0;
 
@@ -335,25 +402,25 @@ void error_lines_have_prefix(struct ProgramState *state) {
                 break;
 
             /* Character is not numeric, and was not a colon */
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": first non-numeric character of line %i of input must be a colon (:), got '%c'\n", line_index + 1, character);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": first non-numeric character of line %s of input must be a colon (:), got '%c'\n", get_location(state, line_index), character);
             exit(EXIT_INCOMPLETE_LINE_NUMBER);
         }
 
         /* If char_index is still 0, that means there was no number. */
         if(char_index == 0) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected a line number\n", line_index + 1);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected a line number\n", get_location(state, line_index));
             exit(EXIT_EXPECTED_LINE_NUMBER);
         }
 
         /* Line is not missing a ':', it does not even have anything past this point */
         if((char_index + 1) > line.length) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected ':' after line number, got the end of the line\n", line_index + 1);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected ':' after line number, got the end of the line\n", get_location(state, line_index));
             exit(EXIT_EXPECTED_COLON);
         }
 
         /* Next character must be a ':' */
         if(line.contents[char_index] != ':') {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected ':' after line number, got '%c'\n", line_index + 1, line.contents[char_index]);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected ':' after line number, got '%c'\n", get_location(state, line_index), line.contents[char_index]);
             exit(EXIT_EXPECTED_COLON);
         }
 
@@ -361,13 +428,13 @@ void error_lines_have_prefix(struct ProgramState *state) {
 
         /* Line is not missing a '@', it does not even have anything past this point */
         if((char_index + 1) > line.length) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected '@' after colon, got the end of the line\n", line_index + 1);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected '@' after colon, got the end of the line\n", get_location(state, line_index));
             exit(EXIT_EXPECTED_AT_SIGN);
         }
 
         /* Next character must be a '@' */
         if(line.contents[char_index] != '@') {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected '@' after line number, got '%c'\n", line_index + 1, line.contents[char_index]);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected '@' after line number, got '%c'\n", get_location(state, line_index), line.contents[char_index]);
             exit(EXIT_EXPECTED_COLON);
         }
     }
@@ -411,7 +478,7 @@ void error_all_tags_recognized(struct ProgramState *state) {
             continue;
 
         /* This is not a tag we recognize. */
-        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": unrecognized tag '%s' on line %i\n", state->tag_name.contents, line_index + 1);
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": unrecognized tag '%s' on line %s\n", state->tag_name.contents, get_location(state, line_index));
         exit(EXIT_UNRECOGNIZED_TAG);
     }
 }
@@ -470,7 +537,7 @@ void error_tag_is_closed(struct ProgramState *state, const char *start_tag, cons
     if(in_multiline == 0)
         return;
 
-    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": tag '%s' on line %i not closed\n", start_tag, multiline_tag_line + 1);
+    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": tag '%s' on line %s not closed\n", start_tag, get_location(state, multiline_tag_line));
     exit(EXIT_UNCLOSED_TAG);
 }
 
@@ -512,31 +579,31 @@ void error_fields_have_text(struct ProgramState *state) {
 
         /* No text, basically just a blank '\d+:@' */
         if(state->tag_name.length == 1) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected name of tag on line %i, got nothing\n", line_index + 1); 
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected name of tag on line %s, got nothing\n", get_location(state, line_index)); 
             exit(EXIT_EXPECTED_TEXT);
         }
 
         /* We have the name of the tag (and we assume its valid, since this should
          * be ran after all tags have been checked), but is there a ':'? */
         if(CHAR_OFFSET(line.contents, at_sign + state->tag_name.length) >= line.length) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected ':' after tag name, got end of line\n", line_index + 1); 
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected ':' after tag name, got end of line\n", get_location(state, line_index)); 
             exit(EXIT_EXPECTED_COLON);
         }
 
         if(*(at_sign + state->tag_name.length) != ':') {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected ':' after tag name, got '%c'\n", line_index + 1, *(at_sign + state->tag_name.length)); 
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected ':' after tag name, got '%c'\n", get_location(state, line_index), *(at_sign + state->tag_name.length)); 
             exit(EXIT_EXPECTED_COLON);
         }
 
         /* Is there any text after the ':'? */
         if(CHAR_OFFSET(line.contents, colon_sign + 1) >= line.length) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected space after colon got the end of the line\n", line_index + 1);
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected space after colon got the end of the line\n", get_location(state, line_index));
             exit(EXIT_EXPECTED_COLON);
         }
 
         /* The first character must be a space */
         if(isspace((*(colon_sign + 1))) == 0) {
-            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %i expected space after colon got '%c'\n", line_index + 1, (*(colon_sign + 1)));
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": line %s expected space after colon got '%c'\n", get_location(state, line_index), (*(colon_sign + 1)));
             exit(EXIT_EXPECTED_SPACE);
         }
     }
@@ -577,7 +644,7 @@ void error_tag_outside_of_docgen_pair(struct ProgramState *state) {
         if(in_docgen_tag == 1)
             continue;
 
-        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": tag '%s' on line %i outside of pair of docgen tags\n", state->tag_name.contents, line_index + 1);
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": tag '%s' on line %s outside of pair of docgen tags\n", state->tag_name.contents, get_location(state, line_index));
         exit(EXIT_TAG_OUTSIDE_OF_GROUP);
     }
 }
@@ -621,7 +688,7 @@ void check_postrequisites(struct ProgramState *state, int index, const char *tag
         if(strcmp(state->tag_name.contents, next_tag) == 0)
             continue;
 
-        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected tag '%s' to follow tag '%s' on line %i, got '%s'\n", next_tag, tag, index + 1, state->tag_name.contents);
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected tag '%s' to follow tag '%s' on line %s, got '%s'\n", next_tag, tag, get_location(state, index), state->tag_name.contents);
         exit(EXIT_EXPECTED_TAG);
     }
 
@@ -633,7 +700,7 @@ void check_postrequisites(struct ProgramState *state, int index, const char *tag
     
     LIBERROR_IS_NULL(next_tag);
 
-    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected tag '%s' to follow tag '%s' on line %i\n", next_tag, tag, index + 1);
+    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected tag '%s' to follow tag '%s' on line %s\n", next_tag, tag, get_location(state, index));
     exit(EXIT_EXPECTED_TAG);
 }
 
@@ -935,9 +1002,16 @@ void compile_references(struct ProgramState *state, int start_index) {
 
         /* Dump reference tags */
         if(strcmp(state->tag_name.contents, "@reference") == 0) {
+            const char *name = strchr(line.contents, ' ') + 1;
+            const char *category = strchr(name, '(');
+
+            LIBERROR_IS_NULL(category);
+
+            /* The category is everything inside the parentheses. This
+             * does not use strtok, so blocks can be compiled at once. */
             fprintf(state->compilation_output, "%s", "START_REFERENCE\n"); 
-            fprintf(state->compilation_output, "%s\n", strchr(strtok(line.contents, "("), ' ') + 1); 
-            fprintf(state->compilation_output, "%s\n", strtok(NULL, ")")); 
+            fprintf(state->compilation_output, "%.*s\n", (int) (category - name), name); 
+            fprintf(state->compilation_output, "%.*s\n", (int) strcspn(category + 1, ")"), category + 1); 
             fprintf(state->compilation_output, "%s", "END_REFERENCE\n"); 
 
             continue;
@@ -945,79 +1019,210 @@ void compile_references(struct ProgramState *state, int start_index) {
     }
 }
 
-/* 
+/*
  * =========================================
- *             Main Function
+ *     Requested embeds and selected groups
  * =========================================
 */
 
-int main(void) {
+/* Retrieve the flags of the name of the docgen block starting at an index.
+ * Blocks that are cut short, or have no name, have none. */
+static int block_name_flags(struct ProgramState *state, int docgen_start_index) {
+    int name_id = 0;
+    const char *name = NULL;
+
+    if(docgen_start_index < 0 || docgen_start_index + 2 >= carray_length(state->input_lines))
+        return 0;
+
+    name = strchr(state->input_lines->contents[docgen_start_index + 2].contents, ' ');
+
+    if(name == NULL)
+        return 0;
+
+    name_id = common_intern_find(name + 1);
+
+    if(name_id == COMMON_INTERN_MISSING)
+        return 0;
+
+    return common_intern_flags(name_id);
+}
+
+/* Select the groups with the names given, separated by commas, after
+ * which only those groups are compiled */
+static void select_groups(struct ProgramState *state, const char *names) {
+    const char *cursor = names;
+
+    VERIFY_PROGRAM_STATE(state);
+    LIBERROR_IS_NULL(names);
+
+    while(*cursor != '\0') {
+        int length = (int) strcspn(cursor, ",");
+
+        if(length > 0)
+            common_intern_add_flags(common_intern_length(cursor, length), GROUP_SELECTED);
+
+        cursor += length;
+
+        if(*cursor == ',')
+            cursor++;
+    }
+
+    state->select_groups = 1;
+}
+
+/* Whether the docgen block starting at an index makes a group */
+static int group_is_selected(struct ProgramState *state, int docgen_start_index) {
+    VERIFY_PROGRAM_STATE(state);
+
+    if(state->select_groups == 0)
+        return 1;
+
+    return (block_name_flags(state, docgen_start_index) & GROUP_SELECTED) != 0;
+}
+
+/*
+ * Collect the name of every embed that is requested anywhere in the input,
+ * before any of it is compiled, so only those embeds have to be compiled.
+ * Embeds are requested by "@embed" tags, and macros implicitly request
+ * their own. When only some groups are selected, only their requests
+ * count. This runs before the input is validated, so lines that are not
+ * well formed are skipped, and left for validation to report.
+*/
+static void collect_embed_requests(struct ProgramState *state) {
     int line_index = 0;
-    struct ProgramState state;
+    int in_selected = 0;
 
-    LIBERROR_INIT(state);
+    VERIFY_PROGRAM_STATE(state);
 
-    /* Initialize the program state (mostly for memory re-use */
-    state.input_lines = carray_init(state.input_lines, CSTRING);
-    state.tag_name = cstring_init("");
-    state.compilation_output = stdout;
-    state.temp_function.name = cstring_init("");
-    state.temp_function.return_type = cstring_init("");
-    state.temp_function.return_description  = cstring_init("");
-    state.temp_function.description  = cstring_init("");
-    state.temp_function.parameters = carray_init(state.temp_function.parameters, FUNCTION_PARAMETER);
-    state.temp_macro_function.name = cstring_init("");
-    state.temp_macro_function.description  = cstring_init("");
-    state.temp_macro_function.parameters = carray_init(state.temp_macro_function.parameters, MACRO_FUNCTION_PARAMETER);
+    for(line_index = 0; line_index < carray_length(state->input_lines); line_index++) {
+        const char *type = NULL;
+        const char *name = NULL;
+        struct CString line = state->input_lines->contents[line_index];
+
+        if(strchr(line.contents, '@') == NULL)
+            continue;
+
+        common_parse_read_tag(line, &(state->tag_name));
+
+        if(strcmp(state->tag_name.contents, DOCGEN_END) == 0) {
+            in_selected = 0;
+
+            continue;
+        }
+
+        if(strcmp(state->tag_name.contents, "@embed") == 0) {
+            name = strchr(line.contents, ' ');
+
+            if(name != NULL && (in_selected == 1 || state->select_groups == 0))
+                common_intern_add_flags(common_intern(name + 1), EMBED_REQUESTED);
+
+            continue;
+        }
+
+        if(strcmp(state->tag_name.contents, DOCGEN_START) != 0)
+            continue;
+
+        in_selected = group_is_selected(state, line_index);
+
+        if(in_selected == 0 || line_index + 2 >= carray_length(state->input_lines))
+            continue;
+
+        type = strchr(state->input_lines->contents[line_index + 1].contents, ' ');
+        name = strchr(state->input_lines->contents[line_index + 2].contents, ' ');
+
+        if(type == NULL || name == NULL || strcmp(type + 1, "macro") != 0)
+            continue;
+
+        common_intern_add_flags(common_intern(name + 1), EMBED_REQUESTED);
+    }
+
+    state->demand_embeds = 1;
+}
+
+/* Select the groups to compile, and collect the embeds they request, if
+ * only some of them are to be compiled */
+void select_requests(struct ProgramState *state, struct ProgramArguments arguments) {
+    if(arguments.only != NULL)
+        select_groups(state, arguments.only);
+
+    if(arguments.demand == 1 || arguments.only != NULL)
+        collect_embed_requests(state);
+}
+
+/*
+ * =========================================
+ *          Validation and Compilation
+ * =========================================
+*/
+void validate_input(struct ProgramState *state) {
+    VERIFY_PROGRAM_STATE(state);
 
-    common_parse_readlines(state.input_lines, stdin);
+    /* Lines read from a source file never have a line number prefix */
+    if(state->from_source == 0)
+        error_lines_have_prefix(state);
 
-    error_lines_have_prefix(&state);
-    error_all_tags_recognized(&state);
-    error_fields_have_text(&state);
+    error_all_tags_recognized(state);
+    error_fields_have_text(state);
 
     /* Verify all multiline tags are closed */
-    error_tag_is_closed(&state, "@description", "@description");
-    error_tag_is_closed(&state, "@notes", "@notes");
-    error_tag_is_closed(&state, "@examples", "@examples");
-    error_tag_is_closed(&state, "@arguments", "@arguments");
+    error_tag_is_closed(state, "@description", "@description");
+    error_tag_is_closed(state, "@notes", "@notes");
+    error_tag_is_closed(state, "@examples", "@examples");
+    error_tag_is_closed(state, "@arguments", "@arguments");
 
     /* Verify all group tags are closed */
-    error_tag_is_closed(&state, "@docgen_start", "@docgen_end");
+    error_tag_is_closed(state, "@docgen_start", "@docgen_end");
 
     /* Verify all tags have the tags that they require following them */
-    error_tags_have_postrequisites(&state, "@param",       1, "@brief");
-    error_tags_have_postrequisites(&state, "@embed",        1, "@show_brief");
-    error_tags_have_postrequisites(&state, "@docgen_start", 3, "@type", "@name", "@brief");
+    error_tags_have_postrequisites(state, "@param",       1, "@brief");
+    error_tags_have_postrequisites(state, "@embed",        1, "@show_brief");
+    error_tags_have_postrequisites(state, "@docgen_start", 3, "@type", "@name", "@brief");
 
-    error_tag_outside_of_docgen_pair(&state);
+    error_tag_outside_of_docgen_pair(state);
+}
+
+void compile_groups(struct ProgramState *state) {
+    int line_index = 0;
+    int in_skipped = 0;
 
-    /* Scan the stdin for occurrences of the start and end of a docgen block, and
+    VERIFY_PROGRAM_STATE(state);
+
+    /* Scan the input lines for occurrences of the start and end of a docgen block, and
      * produce the markers for them. Once the start is found, invoke the various
      * compilation stages, which will stop themselves once they reach the end of
      * the block they are called in. */
-    for(line_index = 0; line_index < carray_length(state.input_lines); line_index++) {
+    for(line_index = 0; line_index < carray_length(state->input_lines); line_index++) {
         struct CString line;
     
-        VERIFY_CARRAY(state.input_lines);
-        LIBERROR_OUT_OF_BOUNDS(line_index, carray_length(state.input_lines));
-        VERIFY_CSTRING(&(state.input_lines->contents[line_index]));
-        LIBERROR_IS_NULL(strchr((state.input_lines->contents[line_index].contents), '@'));
+        VERIFY_CARRAY(state->input_lines);
+        LIBERROR_OUT_OF_BOUNDS(line_index, carray_length(state->input_lines));
+        VERIFY_CSTRING(&(state->input_lines->contents[line_index]));
+        LIBERROR_IS_NULL(strchr((state->input_lines->contents[line_index].contents), '@'));
 
-        line = state.input_lines->contents[line_index];
-        common_parse_read_tag(line, &(state.tag_name)); 
+        line = state->input_lines->contents[line_index];
+        common_parse_read_tag(line, &(state->tag_name)); 
 
-        VERIFY_CSTRING(&(state.tag_name));
+        VERIFY_CSTRING(&(state->tag_name));
 
         /* Note, the lack of 'continue;' here is intentional. The
          * fall through will 'signal' the code below it to start
          * performing compilation, as if the tag is not a start or
          * end tag, it will be ignored, so the only case where
          * the tag will not be ignored is when its the start tag. */
-        if(strcmp(state.tag_name.contents, DOCGEN_START) == 0) {
-            fprintf(state.compilation_output, "START_GROUP %s\n", strchr(state.input_lines->contents[line_index + 2].contents, ' ') + 1);
-        } else if(strcmp(state.tag_name.contents, DOCGEN_END) == 0) {
-            fprintf(state.compilation_output, "%s", "END_GROUP\n");
+        if(strcmp(state->tag_name.contents, DOCGEN_START) == 0) {
+            /* Blocks that were not selected are only here for their embeds */
+            if(group_is_selected(state, line_index) == 0) {
+                in_skipped = 1;
+
+                continue;
+            }
+
+            fprintf(state->compilation_output, "START_GROUP %s\n", strchr(state->input_lines->contents[line_index + 2].contents, ' ') + 1);
+        } else if(strcmp(state->tag_name.contents, DOCGEN_END) == 0) {
+            if(in_skipped == 0)
+                fprintf(state->compilation_output, "%s", "END_GROUP\n");
+
+            in_skipped = 0;
 
             continue;
         } else {
@@ -1025,71 +1230,781 @@ int main(void) {
         }
 
         /* Generate some of the other sections */
-        fprintf(state.compilation_output, "%s", "START_SECTION NAME\n");
-        fprintf(state.compilation_output, "%s - %s\n", strchr(state.input_lines->contents[line_index + 2].contents, ' ') + 1, strchr(state.input_lines->contents[line_index + 3].contents, ' ') + 1);
-        fprintf(state.compilation_output, "%s", "END_SECTION\n");
+        fprintf(state->compilation_output, "%s", "START_SECTION NAME\n");
+        fprintf(state->compilation_output, "%s - %s\n", strchr(state->input_lines->contents[line_index + 2].contents, ' ') + 1, strchr(state->input_lines->contents[line_index + 3].contents, ' ') + 1);
+        fprintf(state->compilation_output, "%s", "END_SECTION\n");
 
 
         /* Begin the various compilation phases, where each (except
          * embedding) starts at our current index, and stops when it
          * reaches the end of the block.  */
-        compile_inclusion(&state, line_index);
-        compile_multilines(&state, line_index);
-        compile_embed_requests(&state, line_index);
+        compile_inclusion(state, line_index);
+        compile_multilines(state, line_index);
+        compile_embed_requests(state, line_index);
 
         /* If there is text in the description AND we have (errors OR parameters) to write,
          * they need an empty line in between */
-        if(has_description(&state, line_index) == 1 && ((has_errors(&state, line_index) == 1) || (has_parameters(&state, line_index) == 1))) {
-            fprintf(state.compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
-            fprintf(state.compilation_output, "%s", "\n\n");
-            fprintf(state.compilation_output, "%s", "END_APPEND_TO\n");
+        if(has_description(state, line_index) == 1 && ((has_errors(state, line_index) == 1) || (has_parameters(state, line_index) == 1))) {
+            fprintf(state->compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
+            fprintf(state->compilation_output, "%s", "\n\n");
+            fprintf(state->compilation_output, "%s", "END_APPEND_TO\n");
         }
 
         /* Add pre-text to the error list */
-        if(has_errors(&state, line_index) == 1) {
-            fprintf(state.compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
-            fprintf(state.compilation_output, "%s", "When the following conditions are met, this will produce"
+        if(has_errors(state, line_index) == 1) {
+            fprintf(state->compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
+            fprintf(state->compilation_output, "%s", "When the following conditions are met, this will produce"
                                                      "  an error message to stderr, and abort the program.\n"); 
-            fprintf(state.compilation_output, "%s", "END_APPEND_TO\n");
+            fprintf(state->compilation_output, "%s", "END_APPEND_TO\n");
         }
 
-        compile_errors(&state, line_index);
+        compile_errors(state, line_index);
 
         /* If there is errors AND parameters, we need an extra newline
          * between the two */
-        if((has_errors(&state, line_index) == 1) && (has_parameters(&state, line_index) == 1)) {
-            fprintf(state.compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
-            fprintf(state.compilation_output, "%s", "\n");
-            fprintf(state.compilation_output, "%s", "END_APPEND_TO\n");
+        if((has_errors(state, line_index) == 1) && (has_parameters(state, line_index) == 1)) {
+            fprintf(state->compilation_output, "%s", "START_APPEND_TO DESCRIPTION\n");
+            fprintf(state->compilation_output, "%s", "\n");
+            fprintf(state->compilation_output, "%s", "END_APPEND_TO\n");
         }
 
-        compile_parameters(&state, line_index);
-        compile_references(&state, line_index);
+        compile_parameters(state, line_index);
+        compile_references(state, line_index);
 
         /* Functions and macro functions implicitly embed themselves with no brief showed */
-        if(strcmp(strchr(state.input_lines->contents[line_index + 1].contents, ' ') + 1, "macro") == 0) {
-            fprintf(state.compilation_output, "%s", "START_EMBED_REQUEST ");
-            fprintf(state.compilation_output, "%s\n", strchr(state.input_lines->contents[line_index + 2].contents, ' ') + 1);
-            fprintf(state.compilation_output, "%i\n", 0);
-            fprintf(state.compilation_output, "%s", "END_EMBED_REQUEST\n");
+        if(strcmp(strchr(state->input_lines->contents[line_index + 1].contents, ' ') + 1, "macro") == 0) {
+            fprintf(state->compilation_output, "%s", "START_EMBED_REQUEST ");
+            fprintf(state->compilation_output, "%s\n", strchr(state->input_lines->contents[line_index + 2].contents, ' ') + 1);
+            fprintf(state->compilation_output, "%i\n", 0);
+            fprintf(state->compilation_output, "%s", "END_EMBED_REQUEST\n");
          }
     }
+}
+
+/* Compile all the embeds. This happens agnostic of the line index. */
+void compile_embeds(struct ProgramState *state) {
+    VERIFY_PROGRAM_STATE(state);
+
+    compile_macro_embeds(state);
+}
+
+/* Release the lines that have been compiled, but keep the array around
+ * for the next ones */
+void release_lines(struct ProgramState *state) {
+    int line_index = 0;
+
+    for(line_index = 0; line_index < carray_length(state->input_lines); line_index++) {
+        cstring_free(state->input_lines->contents[line_index]);
+    }
+
+    state->line_offset += carray_length(state->input_lines);
+    state->input_lines->length = 0;
+
+    if(state->line_numbers != NULL)
+        state->line_numbers->length = 0;
+}
+
+/*
+ * Validate and compile the input one docgen block at a time, rather than
+ * reading all of it first. Lines are buffered until the line with the end
+ * of a docgen block is read, at which point the buffered lines go through
+ * the same validation and compilation as the whole input would, and the
+ * output (embeds included) is flushed right away. The buffer is then
+ * released, so only the largest block ever needs to be held in memory.
+ *
+ * Anything left in the buffer at the end of the input, or at the start
+ * of the tags of another file, is validated too, which is where unclosed
+ * blocks and stray tags are reported.
+*/
+void compile_stream(struct ProgramState *state, FILE *location) {
+    struct CString line = cstring_init("");
+
+    VERIFY_PROGRAM_STATE(state);
+    LIBERROR_IS_NULL(location);
+
+    while(common_parse_readline(&line, location) == 1) {
+        /* The tags of another file start here, so whatever is left of the
+         * last one is validated and compiled on its own first. */
+        if(is_file_record(line) == 1) {
+            if(carray_length(state->input_lines) != 0) {
+                validate_input(state);
+                compile_groups(state);
+                compile_embeds(state);
+                release_lines(state);
+            }
+
+            if(state->line_numbers == NULL) {
+                state->line_numbers = carray_init(state->line_numbers, LINE_NUMBER);
+            }
+
+            cstring_reset(&(state->file_name));
+            cstring_concats(&(state->file_name), line.contents + strlen(COMMON_PARSE_FILE_RECORD));
+            state->line_offset = 0;
+            continue;
+        }
+
+        if(state->line_numbers != NULL) {
+            int line_number = extracted_line_number(line, carray_length(state->input_lines) + 1);
+
+            carray_append(state->line_numbers, line_number, LINE_NUMBER);
+        }
+
+        carray_append(state->input_lines, line, CSTRING);
+        line = cstring_init("");
+
+        /* Malformed lines are left for the validation to report */
+        if(strchr(state->input_lines->contents[carray_length(state->input_lines) - 1].contents, '@') == NULL)
+            continue;
+
+        common_parse_read_tag(state->input_lines->contents[carray_length(state->input_lines) - 1], &(state->tag_name));
+
+        if(strcmp(state->tag_name.contents, DOCGEN_END) != 0)
+            continue;
+
+        validate_input(state);
+        compile_groups(state);
+        compile_embeds(state);
+        fflush(state->compilation_output);
+        release_lines(state);
+    }
+
+    cstring_free(line);
+
+    if(carray_length(state->input_lines) != 0) {
+        validate_input(state);
+        compile_groups(state);
+        compile_embeds(state);
+    }
+
+    if(state->line_numbers != NULL)
+        carray_free(state->line_numbers, LINE_NUMBER);
+}
+
+/*
+ * =========================
+ * # Parallel compilation  #
+ * =========================
+*/
+
+/* Every pass over the input which writes output, in the order that
+ * their output is written in. */
+void (*compile_passes[])(struct ProgramState *state) = {
+    compile_groups,
+    compile_macro_embeds,
+    NULL
+};
+
+/* Set up the scratch space a state re-uses between blocks */
+void init_scratch(struct ProgramState *state) {
+    state->tag_name = cstring_init("");
+    state->file_name = cstring_init("");
+    state->location = cstring_init("");
+    state->temp_function.name = cstring_init("");
+    state->temp_function.return_type = cstring_init("");
+    state->temp_function.return_description  = cstring_init("");
+    state->temp_function.description  = cstring_init("");
+    state->temp_function.parameters = carray_init(state->temp_function.parameters, FUNCTION_PARAMETER);
+    state->temp_macro_function.name = cstring_init("");
+    state->temp_macro_function.description  = cstring_init("");
+    state->temp_macro_function.parameters = carray_init(state->temp_macro_function.parameters, MACRO_FUNCTION_PARAMETER);
+}
+
+void free_scratch(struct ProgramState *state) {
+    carray_free(state->temp_function.parameters, FUNCTION_PARAMETER);
+    carray_free(state->temp_macro_function.parameters, MACRO_FUNCTION_PARAMETER);
+
+    cstring_free(state->tag_name);
+    cstring_free(state->file_name);
+    cstring_free(state->location);
+    cstring_free(state->temp_function.description);
+    cstring_free(state->temp_function.name);
+    cstring_free(state->temp_function.return_type);
+    cstring_free(state->temp_function.return_description);
+    cstring_free(state->temp_macro_function.description);
+    cstring_free(state->temp_macro_function.name);
+}
+
+/* Run each compilation pass of a job over its range of blocks, with the
+ * output of each pass going into its own temporary file. */
+void *compile_job(void *argument) {
+    int pass_index = 0;
+    struct CompileJob *job = argument;
+
+    for(pass_index = 0; compile_passes[pass_index] != NULL; pass_index++) {
+        job->state.compilation_output = job->pass_outputs[pass_index];
+        compile_passes[pass_index](&job->state);
+    }
+
+    return NULL;
+}
+
+/* Write the entire contents of a temporary file out */
+void copy_output(FILE *output, FILE *location) {
+    size_t read_length = 0;
+    char buffer[BUFSIZ];
+
+    rewind(output);
+
+    while((read_length = fread(buffer, 1, sizeof(buffer), output)) != 0) {
+        fwrite(buffer, 1, read_length, location);
+    }
+}
+
+/*
+ * Compile validated input on several threads. Blocks do not depend on
+ * each other once validated, so the input is split into one range of
+ * whole blocks per job, and each job runs every compilation pass over
+ * its range. Since each pass writes all of its output before the next
+ * one starts, the output of each job is kept per pass, and written out
+ * pass by pass, job by job, which makes it identical to compiling the
+ * input on one thread.
+*/
+void compile_parallel(struct ProgramState *state, int jobs) {
+    int job_index = 0;
+    int pass_index = 0;
+    int line_index = 0;
+    int pass_count = 0;
+    struct LineNumbers *block_starts = NULL;
+    struct CompileJob *compile_jobs = NULL;
+
+    VERIFY_PROGRAM_STATE(state);
+
+    /* Find where each block starts, the same way compile_groups does */
+    block_starts = carray_init(block_starts, LINE_NUMBER);
+
+    for(line_index = 0; line_index < carray_length(state->input_lines); line_index++) {
+        common_parse_read_tag(state->input_lines->contents[line_index], &(state->tag_name));
+
+        if(strcmp(state->tag_name.contents, DOCGEN_START) != 0)
+            continue;
+
+        carray_append(block_starts, line_index, LINE_NUMBER);
+    }
+
+    for(pass_count = 0; compile_passes[pass_count] != NULL; pass_count++);
+
+    /* There is no use in having more jobs than blocks */
+    if(jobs > carray_length(block_starts))
+        jobs = carray_length(block_starts);
+
+    if(jobs == 0)
+        jobs = 1;
+
+    compile_jobs = malloc(sizeof(*compile_jobs) * (size_t) jobs);
+
+    for(job_index = 0; job_index < jobs; job_index++) {
+        struct CompileJob *job = compile_jobs + job_index;
+        int start_block = carray_length(block_starts) * job_index / jobs;
+        int end_block = carray_length(block_starts) * (job_index + 1) / jobs;
+        int start_line = job_index == 0 ? 0 : block_starts->contents[start_block];
+        int end_line = carray_length(state->input_lines);
+
+        if(end_block < carray_length(block_starts))
+            end_line = block_starts->contents[end_block];
+
+        /* The lines of a job are borrowed from the whole input */
+        job->lines.length = end_line - start_line;
+        job->lines.capacity = job->lines.length;
+        job->lines.contents = state->input_lines->contents + start_line;
+
+        LIBERROR_INIT(job->state);
+        job->state.input_lines = &(job->lines);
+        job->state.line_offset = state->line_offset + start_line;
+        job->state.demand_embeds = state->demand_embeds;
+        job->state.select_groups = state->select_groups;
+        init_scratch(&(job->state));
+
+        job->pass_outputs = malloc(sizeof(*job->pass_outputs) * (size_t) pass_count);
+
+        for(pass_index = 0; pass_index < pass_count; pass_index++) {
+            job->pass_outputs[pass_index] = tmpfile();
+            LIBERROR_FILE_OPEN_FAILURE(job->pass_outputs[pass_index], "temporary file");
+        }
+    }
+
+#ifdef COMPILE_THREADED
+    {
+        pthread_t *threads = malloc(sizeof(*threads) * (size_t) jobs);
+
+        for(job_index = 0; job_index < jobs; job_index++) {
+            if(pthread_create(threads + job_index, NULL, compile_job, compile_jobs + job_index) == 0)
+                continue;
+
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to start a thread for job %i\n", job_index);
+            exit(EXIT_FAILURE);
+        }
+
+        for(job_index = 0; job_index < jobs; job_index++) {
+            pthread_join(threads[job_index], NULL);
+        }
+
+        free(threads);
+    }
+#else
+    for(job_index = 0; job_index < jobs; job_index++) {
+        compile_job(compile_jobs + job_index);
+    }
+#endif
+
+    /* Write the output pass by pass, in the order of the blocks */
+    for(pass_index = 0; pass_index < pass_count; pass_index++) {
+        for(job_index = 0; job_index < jobs; job_index++) {
+            copy_output(compile_jobs[job_index].pass_outputs[pass_index], state->compilation_output);
+        }
+    }
+
+    for(job_index = 0; job_index < jobs; job_index++) {
+        struct CompileJob *job = compile_jobs + job_index;
+
+        for(pass_index = 0; pass_index < pass_count; pass_index++) {
+            fclose(job->pass_outputs[pass_index]);
+        }
+
+        free(job->pass_outputs);
+        free_scratch(&(job->state));
+    }
+
+    free(compile_jobs);
+    carray_free(block_starts, LINE_NUMBER);
+}
+
+/* Compile validated input, on as many threads as there are jobs */
+void compile_input(struct ProgramState *state, int jobs) {
+    VERIFY_PROGRAM_STATE(state);
+
+    if(jobs <= 1) {
+        compile_groups(state);
+        compile_embeds(state);
+
+        return;
+    }
+
+    compile_parallel(state, jobs);
+}
+
+/*
+ * Validate and compile only the blocks of groups selected with --only, and
+ * the blocks with embeds that those groups request. The other blocks are
+ * dropped before validation, so they are neither validated nor compiled,
+ * and neither are any tags outside of a block. The lines that are kept are
+ * borrowed from the input, and keep the line numbers they had in it.
+*/
+void compile_selection(struct ProgramState *state, int jobs) {
+    int keep_block = 0;
+    int line_index = 0;
+    struct CStrings kept_lines;
+    struct CStrings *all_lines = state->input_lines;
+    struct LineNumbers *all_numbers = state->line_numbers;
+    struct LineNumbers *kept_numbers = NULL;
+
+    VERIFY_PROGRAM_STATE(state);
+
+    kept_numbers = carray_init(kept_numbers, LINE_NUMBER);
+    kept_lines.length = 0;
+    kept_lines.capacity = carray_length(all_lines) + 1;
+    kept_lines.contents = malloc(sizeof(*kept_lines.contents) * (size_t) kept_lines.capacity);
+
+    for(line_index = 0; line_index < carray_length(all_lines); line_index++) {
+        struct CString line = all_lines->contents[line_index];
+        int is_tag = strchr(line.contents, '@') != NULL;
+
+        if(is_tag == 1)
+            common_parse_read_tag(line, &(state->tag_name));
+
+        if(is_tag == 1 && strcmp(state->tag_name.contents, DOCGEN_START) == 0)
+            keep_block = group_is_selected(state, line_index) == 1
+                         || (block_name_flags(state, line_index) & EMBED_REQUESTED) != 0;
+
+        if(keep_block == 1) {
+            int line_number = get_line_number(state, line_index);
+
+            kept_lines.contents[kept_lines.length] = line;
+            kept_lines.length++;
+            carray_append(kept_numbers, line_number, LINE_NUMBER);
+        }
+
+        if(is_tag == 1 && strcmp(state->tag_name.contents, DOCGEN_END) == 0)
+            keep_block = 0;
+    }
+
+    state->input_lines = &kept_lines;
+    state->line_numbers = kept_numbers;
+
+    validate_input(state);
+    compile_input(state, jobs);
+
+    state->input_lines = all_lines;
+    state->line_numbers = all_numbers;
+
+    free(kept_lines.contents);
+    carray_free(kept_numbers, LINE_NUMBER);
+}
+
+/*
+ * Validate and compile input which is made of the tags of several files,
+ * with a FILE record before the tags of each one. Each file is validated
+ * and compiled on its own, as if it were given to its own compiler, but
+ * without starting one. The lines of each file are borrowed from the
+ * whole input, and numbered by the line numbers the extractor gave them.
+ * When checking, the files are only validated.
+*/
+void compile_files(struct ProgramState *state, int jobs, int check) {
+    int line_index = 0;
+    struct CStrings *all_lines = state->input_lines;
+
+    VERIFY_PROGRAM_STATE(state);
+
+    state->line_numbers = carray_init(state->line_numbers, LINE_NUMBER);
+
+    while(line_index < carray_length(all_lines)) {
+        struct CStrings file_lines;
+        int file_start = line_index;
+
+        /* Lines before the first FILE record belong to no file */
+        cstring_reset(&(state->file_name));
+
+        if(is_file_record(all_lines->contents[line_index]) == 1) {
+            cstring_concats(&(state->file_name), all_lines->contents[line_index].contents + strlen(COMMON_PARSE_FILE_RECORD));
+            file_start++;
+        }
+
+        state->line_numbers->length = 0;
+
+        for(line_index = file_start; line_index < carray_length(all_lines); line_index++) {
+            int line_number = 0;
+
+            if(is_file_record(all_lines->contents[line_index]) == 1)
+                break;
+
+            line_number = extracted_line_number(all_lines->contents[line_index], line_index - file_start + 1);
+            carray_append(state->line_numbers, line_number, LINE_NUMBER);
+        }
+
+        file_lines.length = line_index - file_start;
+        file_lines.capacity = file_lines.length;
+        file_lines.contents = all_lines->contents + file_start;
+        state->input_lines = &file_lines;
+
+        if(state->select_groups == 1) {
+            compile_selection(state, jobs);
+        } else {
+            validate_input(state);
+
+            if(check == 0)
+                compile_input(state, jobs);
+        }
+
+        state->input_lines = all_lines;
+    }
+
+    carray_free(state->line_numbers, LINE_NUMBER);
+}
+
+/* Whether any line of input is a FILE record */
+int has_file_records(struct CStrings lines) {
+    int line_index = 0;
+
+    for(line_index = 0; line_index < carray_length(&lines); line_index++) {
+        if(is_file_record(lines.contents[line_index]) == 1)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Add each line of a docgen block of a source file with a tag on it
+ * to an input, starting at its '@', along with its line number */
+void read_block_tags(struct TextBlock block, struct CStrings *lines, struct LineNumbers *line_numbers) {
+    int line_number = block.line_index;
+    const char *cursor = block.start;
+
+    while(cursor < block.end) {
+        int tag_index = 0;
+        struct CString line;
+        struct CStringView tag_view;
+        const char *line_end = memchr(cursor, '\n', (size_t) (block.end - cursor));
+
+        if(line_end == NULL)
+            line_end = block.end;
+
+        line_number++;
+
+        line.contents = (char *) cursor;
+        line.length = (int) (line_end - cursor);
+        line.capacity = line.length + 1;
+        cursor = line_end + 1;
+
+        /* Ignore this line. Not a tag. */
+        if(common_parse_line_has_tag(line) == 0)
+            continue;
+
+        tag_index = common_parse_get_tag_index(line);
+        LIBERROR_IS_NEGATIVE(tag_index);
+        LIBERROR_OUT_OF_BOUNDS(tag_index, line.length);
+
+        tag_view.contents = line.contents + tag_index;
+        tag_view.length = line.length - tag_index;
+
+        line = cstring_init("");
+        common_parse_concat_view(&line, tag_view);
+
+        carray_append(lines, line, CSTRING);
+        carray_append(line_numbers, line_number, LINE_NUMBER);
+    }
+}
+
+/*
+ * Read the tags straight out of a source file, rather than out of the
+ * output of an extractor. The docgen blocks of the file are found, and
+ * each line in them with a tag on it is found, with the same rules the
+ * extractor uses, so an '@' outside of a block is never taken for a tag.
+ * Each tag line is added to the input starting at its '@', which is what
+ * the extractor would have written after the line number. The line
+ * number itself is kept on the side, so there is no prefix to write out,
+ * and then validate and strip again.
+*/
+void read_source(struct ProgramState *state, FILE *location) {
+    int block_index = 0;
+    struct CString text;
+    struct TextBlocks *blocks = NULL;
+
+    VERIFY_PROGRAM_STATE(state);
+    LIBERROR_IS_NULL(location);
+
+    common_parse_read_text(&text, location);
+    blocks = carray_init(blocks, TEXT_BLOCK);
+    common_parse_find_blocks(text, blocks);
+
+    state->line_numbers = carray_init(state->line_numbers, LINE_NUMBER);
+
+    for(block_index = 0; block_index < carray_length(blocks); block_index++) {
+        read_block_tags(blocks->contents[block_index], state->input_lines, state->line_numbers);
+    }
+
+    carray_free(blocks, TEXT_BLOCK);
+    cstring_free(text);
+}
+
+/*
+ * Validate the tags of each source file given, without compiling them.
+ * The tags are read straight from each file, so checking a whole tree
+ * needs neither an extractor nor any of the compilation passes, and
+ * writes nothing unless there is an error, which exits with its code
+ * just like it would when compiling.
+*/
+void check_sources(struct ProgramState *state, struct ProgramArguments arguments) {
+    int file_index = 0;
+
+    VERIFY_PROGRAM_STATE(state);
+
+    state->from_source = 1;
+
+    for(file_index = 0; file_index < arguments.file_count; file_index++) {
+        FILE *source_file = fopen(arguments.files[file_index], "r");
+
+        LIBERROR_FILE_OPEN_FAILURE(source_file, arguments.files[file_index]);
+
+        read_source(state, source_file);
+        fclose(source_file);
+
+        cstring_reset(&(state->file_name));
+        cstring_concats(&(state->file_name), arguments.files[file_index]);
+
+        validate_input(state);
+
+        release_lines(state);
+        carray_free(state->line_numbers, LINE_NUMBER);
+    }
+
+    state->line_numbers = NULL;
+}
+
+/*
+ * =====================
+ * # Argument handling #
+ * =====================
+*/
+struct ProgramArguments parse_arguments(int argc, char **argv) {
+    int argument_index = 0;
+    struct ProgramArguments arguments = {1, 0, 0, 0, NULL, NULL, 0, NULL};
+    struct ArgparseParser parser = argparse_init(PROGRAM_NAME, argc, argv);
+
+    /* Any number of files can be given to check */
+    argparse_variable_arguments(parser);
+
+    /* These are the options we want to accept */
+    argparse_add_option(&parser, "-S", "--stream", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-s", "--source", 1);
+    argparse_add_option(&parser, "-j", "--jobs", 1);
+    argparse_add_option(&parser, "-c", "--check", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-d", "--demand", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-o", "--only", 1);
+
+    /* Display the help message */
+    if(argparse_option_exists(parser, "-h") != 0 || argparse_option_exists(parser, "--help") != 0) {
+        int line_index = 0;
+
+        for(line_index = 0; help_message[line_index] != NULL; line_index++) {
+            fprintf(LIBERROR_STREAM, "%s", help_message[line_index]);
+        }
+
+        exit(1);
+    }
+
+    argparse_error(parser);
+
+    if(argparse_option_exists(parser, "-S") != 0 || argparse_option_exists(parser, "--stream") != 0)
+        arguments.stream = 1;
+
+    if(argparse_option_exists(parser, "-c") != 0 || argparse_option_exists(parser, "--check") != 0)
+        arguments.check = 1;
 
-    /* Compile all the embeds. This happens agnostic of the line index. */
-    compile_macro_embeds(&state);
+    if(argparse_option_exists(parser, "-d") != 0 || argparse_option_exists(parser, "--demand") != 0)
+        arguments.demand = 1;
+
+    if(argparse_option_exists(parser, "-o") != 0)
+        arguments.only = argparse_get_option_parameter(parser, "-o", 0);
+    else if(argparse_option_exists(parser, "--only") != 0)
+        arguments.only = argparse_get_option_parameter(parser, "--only", 0);
+
+    if(argparse_option_exists(parser, "-s") != 0)
+        arguments.source = argparse_get_option_parameter(parser, "-s", 0);
+    else if(argparse_option_exists(parser, "--source") != 0)
+        arguments.source = argparse_get_option_parameter(parser, "--source", 0);
+
+    if(argparse_option_exists(parser, "-j") != 0)
+        arguments.jobs = atoi(argparse_get_option_parameter(parser, "-j", 0));
+    else if(argparse_option_exists(parser, "--jobs") != 0)
+        arguments.jobs = atoi(argparse_get_option_parameter(parser, "--jobs", 0));
+
+    if(arguments.jobs <= 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": the amount of jobs must be a positive number\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    arguments.files = malloc(sizeof(*arguments.files) * (size_t) argc);
+
+    argparse_argument_variable_iter(parser, argument_index) {
+        arguments.files[arguments.file_count] = argparse_get_index(parser, argument_index);
+        arguments.file_count++;
+    }
+
+    /* A source file given to check is checked like any other */
+    if(arguments.check == 1 && arguments.source != NULL) {
+        arguments.files[arguments.file_count] = arguments.source;
+        arguments.file_count++;
+    }
+
+    /* Streaming only reads the output of an extractor, and compiles it */
+    if(arguments.stream == 1 && (arguments.source != NULL || arguments.check == 1)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --stream cannot be used with --source or --check\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    /* Streaming compiles each block as soon as it is read, one at a time */
+    if(arguments.jobs != 1 && arguments.stream == 1) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --jobs cannot be used with --stream\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every embed a block requests has to have been read before it */
+    if(arguments.demand == 1 && arguments.stream == 1) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --demand cannot be used with --stream\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(arguments.only != NULL && (arguments.stream == 1 || arguments.check == 1)) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": --only cannot be used with --stream or --check\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    if(arguments.file_count > 0 && arguments.check == 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": files can only be given with --check. use --source to compile one\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    argparse_free(parser);
+
+    return arguments;
+}
+
+/* 
+ * =========================================
+ *             Main Function
+ * =========================================
+*/
+
+int main(int argc, char **argv) {
+    struct ProgramState state;
+    struct ProgramArguments arguments = parse_arguments(argc, argv);
+
+    LIBERROR_INIT(state);
+    register_tags();
+
+    /* Initialize the program state (mostly for memory re-use */
+    state.input_lines = carray_init(state.input_lines, CSTRING);
+    state.compilation_output = stdout;
+    init_scratch(&state);
+
+    if(arguments.check == 1 && arguments.file_count > 0) {
+        check_sources(&state, arguments);
+    } else if(arguments.check == 1) {
+        common_parse_readlines(state.input_lines, stdin);
+
+        if(has_file_records(*state.input_lines) == 1)
+            compile_files(&state, arguments.jobs, 1);
+        else
+            validate_input(&state);
+    } else if(arguments.source != NULL) {
+        FILE *source_file = fopen(arguments.source, "r");
+
+        LIBERROR_FILE_OPEN_FAILURE(source_file, arguments.source);
+
+        read_source(&state, source_file);
+        fclose(source_file);
+        cstring_concats(&(state.file_name), arguments.source);
+        state.from_source = 1;
+
+        select_requests(&state, arguments);
+
+        if(state.select_groups == 1) {
+            compile_selection(&state, arguments.jobs);
+        } else {
+            validate_input(&state);
+            compile_input(&state, arguments.jobs);
+        }
+
+        carray_free(state.line_numbers, LINE_NUMBER);
+    } else if(arguments.stream == 1) {
+        compile_stream(&state, stdin);
+    } else {
+        common_parse_readlines(state.input_lines, stdin);
+
+        /* Requests are collected over every file, since the backend
+         * resolves them over the whole of its input */
+        select_requests(&state, arguments);
+
+        if(has_file_records(*state.input_lines) == 1) {
+            compile_files(&state, arguments.jobs, 0);
+        } else if(state.select_groups == 1) {
+            compile_selection(&state, arguments.jobs);
+        } else {
+            validate_input(&state);
+            compile_input(&state, arguments.jobs);
+        }
+    }
 
     /* Cleanup */
+    free(arguments.files);
     carray_free(state.input_lines, CSTRING);
-    carray_free(state.temp_function.parameters, FUNCTION_PARAMETER);
-    carray_free(state.temp_macro_function.parameters, MACRO_FUNCTION_PARAMETER);
-
-    cstring_free(state.tag_name);
-    cstring_free(state.temp_function.description);
-    cstring_free(state.temp_function.name);
-    cstring_free(state.temp_function.return_type);
-    cstring_free(state.temp_function.return_description);
-    cstring_free(state.temp_macro_function.description);
-    cstring_free(state.temp_macro_function.name);
+    free_scratch(&state);
+    common_intern_free();
 
     return EXIT_SUCCESS;
 }
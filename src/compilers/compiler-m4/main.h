@@ -45,6 +45,18 @@
 #define DOCGEN_START    "@docgen_start"
 #define DOCGEN_END      "@docgen_end"
 
+/* Tag kinds, attached to each known tag in the intern table */
+#define TAG_MULTILINE   1
+#define TAG_FIELD       2
+#define TAG_GROUP       4
+
+/* Attached to the name of each embed that is requested, in the intern
+ * table, when only requested embeds are compiled */
+#define EMBED_REQUESTED 8
+
+/* Attached to the name of each group selected with --only */
+#define GROUP_SELECTED  16
+
 /* Exit codes */
 #define EXIT_UNCLOSED_DOCGEN            2
 #define EXIT_INCOMPLETE_LINE_NUMBER     3
@@ -71,6 +83,10 @@
     VERIFY_CSTRING(&((state)->tag_name));          \
     VERIFY_CARRAY((state)->input_lines)
 
+#define LINE_NUMBER_TYPE int
+#define LINE_NUMBER_HEAP 1
+#define LINE_NUMBER_FREE(value)
+
 #define FUNCTION_PARAMETER_TYPE struct FunctionParameter
 #define FUNCTION_PARAMETER_HEAP 1
 #define FUNCTION_PARAMETER_FREE(value) \
@@ -132,6 +148,31 @@ struct MacroFunction {
     struct CString return_description;
 };
 
+/* The command line arguments for the program */
+/* A tag, and the kinds it belongs to */
+struct TagKind {
+    const char *name;
+    int flags;
+};
+
+struct ProgramArguments {
+    int jobs;
+    int stream;
+    int check;
+    int demand;
+    char *only;
+    char *source;
+    int file_count;
+    char **files;
+};
+
+/* The line number in the source file of each line of input */
+struct LineNumbers {
+    int length;
+    int capacity;
+    int *contents;
+};
+
 /* Container of state for the program. Contains common
  * data for memory reusage. */
 struct ProgramState {
@@ -140,6 +181,39 @@ struct ProgramState {
     struct CString tag_name;
     struct CStrings *input_lines;
     FILE *compilation_output;
+
+    /* The number of lines of input that came before the first
+     * line in input_lines. Only non-zero when streaming. */
+    int line_offset;
+
+    /* The line number in the source file of each line in input_lines,
+     * when the tags were read straight from a source file, or when the
+     * input has FILE records. NULL otherwise. */
+    struct LineNumbers *line_numbers;
+
+    /* Whether the input was read straight from a source file, in which
+     * case its lines have no line number prefix. */
+    int from_source;
+
+    /* Whether only the embeds that something requests are compiled */
+    int demand_embeds;
+
+    /* Whether only the groups selected with --only are compiled */
+    int select_groups;
+
+    /* The file the input came from, if it is known, and where a line
+     * is in it, for diagnostics. */
+    struct CString file_name;
+    struct CString location;
+};
+
+/* A range of docgen blocks compiled on its own thread. Each job has
+ * its own scratch space, and writes the output of each compilation
+ * pass into its own temporary file. */
+struct CompileJob {
+    struct ProgramState state;
+    struct CStrings lines;
+    FILE **pass_outputs;
 };
 
 #endif
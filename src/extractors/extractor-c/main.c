@@ -41,6 +41,11 @@
  * checking and leaves that up to the compiler, since its error checking is much
  * more approachable.
  *
+ * Only the lines from a line with a "@docgen_start" tag to a line with a
+ * "@docgen_end" tag are looked at. The blocks are found in the raw text of the
+ * input before anything is split into lines, so input without any is skipped
+ * in a single pass, and tags outside of a block are never written out.
+ *
  * It does this by scanning each line. If the line starts
  * with a single or double quote before the at-sign, regardless of whether or not the
  * string is closed, the line will be discarded.
@@ -64,6 +69,8 @@
  * you do that, go fix your damn code.
 */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
@@ -74,46 +81,272 @@
 
 #include "main.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+
+#define EXTRACT_THREADED 1
+#endif
+
+static const char *help_message =
+    PROGRAM_NAME " [ --jobs JOBS | -j JOBS ] [ --blocks | -b ] [ FILE... ]\n"
+    "Extract the docgen tags of the docgen blocks in each file given, or in the stdin\n"
+    "if there are none.\n"
+    "The tags of each file are preceded by a 'FILE path' record.\n"
+    "\n"
+    "Optional arguments:\n"
+    "   --jobs, -j JOBS             scan the input on this many threads. defaults to 1\n"
+    "   --blocks, -b                report a docgen block that is never closed, rather than\n"
+    "                               extracting the rest of the input as part of it\n"
+    "";
+
 /*
- * This function will run through each line, and display any docgen tags
- * on that line if there are any.
+ * =========================
+ * # Parallel extraction     #
+ * =========================
 */
-void display_docgen_tags(struct CStrings lines) {
-    int line_index = 0;
 
-    VERIFY_CSTRING(&lines);
+/*
+ * Scan the docgen blocks of a chunk for lines with docgen tags. Since each
+ * block knows the line number it starts on, the tags are recorded with
+ * their line number in the input as they are found.
+*/
+void *scan_chunk(void *argument) {
+    int block_index = 0;
+    struct ExtractionChunk *chunk = argument;
 
-    for(line_index = 0; line_index < carray_length(&lines); line_index++) {
-        int tag_index = 0;
-        struct CString line;
+    for(block_index = 0; block_index < chunk->block_count; block_index++) {
+        struct TextBlock block = chunk->blocks[block_index];
+        const char *cursor = block.start;
+        int line_index = block.line_index;
 
-        LIBERROR_INIT(line);
-        LIBERROR_OUT_OF_BOUNDS(line_index, lines.length);  
-        LIBERROR_IS_NULL(lines.contents[line_index].contents);
-        VERIFY_CSTRING(&lines.contents[line_index]);
+        while(cursor < block.end) {
+            int tag_index = 0;
+            struct CString line;
+            struct TagRecord record;
+            const char *line_end = memchr(cursor, '\n', (size_t) (block.end - cursor));
 
-        line = lines.contents[line_index];
+            if(line_end == NULL)
+                line_end = block.end;
 
-        /* Ignore this line. Not a tag. */
-        if(common_parse_line_has_tag(line) == 0)
-            continue;
+            line.contents = (char *) cursor;
+            line.length = (int) (line_end - cursor);
+            line.capacity = line.length + 1;
+
+            line_index++;
+            cursor = line_end + 1;
+
+            /* Ignore this line. Not a tag. */
+            if(common_parse_line_has_tag(line) == 0)
+                continue;
+
+            tag_index = common_parse_get_tag_index(line);
+            LIBERROR_IS_NEGATIVE(tag_index);
+            LIBERROR_OUT_OF_BOUNDS(tag_index, line.length);
+
+            record.line_index = line_index - 1;
+            record.contents = line.contents + tag_index;
+            record.length = line.length - tag_index;
+
+            carray_append(chunk->records, record, TAG_RECORD);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Display the docgen tags in the docgen blocks of the input. The blocks
+ * are split into one chunk per job, with about the
+ * same amount of text in each, and each chunk is scanned on its own thread.
+ * The tags of each chunk are then displayed in order.
+*/
+void display_docgen_tags(struct TextBlocks blocks, int jobs) {
+    int chunk_index = 0;
+    int chunk_count = 0;
+    int block_index = 0;
+    long block_text = 0;
+    long total_text = 0;
+    struct ExtractionChunk *chunks = NULL;
+
+    LIBERROR_IS_NEGATIVE(jobs);
+    LIBERROR_IS_VALUE(jobs, 0);
+
+    if(carray_length(&blocks) == 0)
+        return;
+
+    for(block_index = 0; block_index < carray_length(&blocks); block_index++) {
+        total_text += blocks.contents[block_index].end - blocks.contents[block_index].start;
+    }
+
+    chunk_count = jobs < carray_length(&blocks) ? jobs : carray_length(&blocks);
+    chunks = malloc(sizeof(*chunks) * (size_t) chunk_count);
+    block_index = 0;
+
+    for(chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+        struct ExtractionChunk *chunk = chunks + chunk_index;
+        long chunk_limit = total_text * (chunk_index + 1) / chunk_count;
+
+        chunk->blocks = blocks.contents + block_index;
+        chunk->block_count = 0;
+        chunk->records = carray_init(chunk->records, TAG_RECORD);
+
+        /* Take blocks until this chunk has its share of the text, leaving
+         * at least one block for each of the chunks after it */
+        while(block_index < carray_length(&blocks) - (chunk_count - chunk_index - 1)
+              && (chunk->block_count == 0 || block_text < chunk_limit || chunk_index == chunk_count - 1)) {
+            block_text += blocks.contents[block_index].end - blocks.contents[block_index].start;
+            chunk->block_count++;
+            block_index++;
+        }
+    }
+
+#ifdef EXTRACT_THREADED
+    if(chunk_count > 1) {
+        pthread_t *threads = malloc(sizeof(*threads) * (size_t) chunk_count);
+
+        for(chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+            if(pthread_create(threads + chunk_index, NULL, scan_chunk, chunks + chunk_index) == 0)
+                continue;
+
+            fprintf(LIBERROR_STREAM, PROGRAM_NAME ": failed to start a thread for chunk %i\n", chunk_index);
+            exit(EXIT_FAILURE);
+        }
+
+        for(chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+            pthread_join(threads[chunk_index], NULL);
+        }
+
+        free(threads);
+    } else {
+        scan_chunk(chunks);
+    }
+#else
+    for(chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+        scan_chunk(chunks + chunk_index);
+    }
+#endif
+
+    /* Display every tag in order */
+    for(chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+        int record_index = 0;
+        struct ExtractionChunk chunk = chunks[chunk_index];
+
+        for(record_index = 0; record_index < carray_length(chunk.records); record_index++) {
+            struct TagRecord record = chunk.records->contents[record_index];
 
-        tag_index = common_parse_get_tag_index(line);
-        LIBERROR_IS_NEGATIVE(tag_index);
-        LIBERROR_OUT_OF_BOUNDS(tag_index, line.length);
+            printf("%i:%.*s\n", record.line_index + 1, record.length, record.contents);
+        }
 
-        printf("%i:%s\n", line_index + 1, line.contents + tag_index);
+        carray_free(chunk.records, TAG_RECORD);
     }
+
+    free(chunks);
 }
 
-int main(void) {
-    struct CStrings *stdin_lines = carray_init(stdin_lines, CSTRING);
+/*
+ * =====================
+ * # Argument handling #
+ * =====================
+*/
+struct ProgramArguments parse_arguments(int argc, char **argv) {
+    int argument_index = 0;
+    struct ProgramArguments arguments = {1, 0, 0, NULL};
+    struct ArgparseParser parser = argparse_init(PROGRAM_NAME, argc, argv);
+
+    /* Any number of files can be given */
+    argparse_variable_arguments(parser);
+
+    /* These are the options we want to accept */
+    argparse_add_option(&parser, "-j", "--jobs", 1);
+    argparse_add_option(&parser, "-b", "--blocks", ARGPARSE_FLAG);
+
+    /* Display the help message */
+    if(argparse_option_exists(parser, "-h") != 0 || argparse_option_exists(parser, "--help") != 0) {
+        fprintf(LIBERROR_STREAM, "%s", help_message); 
+
+        exit(1);
+    }
+
+    argparse_error(parser);
+
+    if(argparse_option_exists(parser, "-j") != 0)
+        arguments.jobs = atoi(argparse_get_option_parameter(parser, "-j", 0));
+    else if(argparse_option_exists(parser, "--jobs") != 0)
+        arguments.jobs = atoi(argparse_get_option_parameter(parser, "--jobs", 0));
 
-    common_parse_readlines(stdin_lines, stdin);
+    if(argparse_option_exists(parser, "-b") != 0 || argparse_option_exists(parser, "--blocks") != 0)
+        arguments.blocks = 1;
+
+    if(arguments.jobs <= 0) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": the amount of jobs must be a positive number\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    arguments.files = malloc(sizeof(*arguments.files) * (size_t) argc);
+
+    argparse_argument_variable_iter(parser, argument_index) {
+        arguments.files[arguments.file_count] = argparse_get_index(parser, argument_index);
+        arguments.file_count++;
+    }
+
+    argparse_free(parser);
+
+    return arguments;
+}
+
+/* Report the first docgen block of a file which is never closed */
+void error_unclosed_blocks(struct TextBlocks blocks, const char *name) {
+    int block_index = 0;
+
+    for(block_index = 0; block_index < carray_length(&blocks); block_index++) {
+        if(blocks.contents[block_index].closed == 1)
+            continue;
+
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": docgen block on line %i of %s is never closed\n",
+                blocks.contents[block_index].line_index + 1, name);
+        exit(EXIT_UNCLOSED_DOCGEN);
+    }
+}
+
+/* Display the docgen tags of a file */
+void extract_file(FILE *location, const char *name, struct ProgramArguments arguments) {
+    struct CString text;
+    struct TextBlocks *blocks = NULL;
+
+    common_parse_read_text(&text, location);
+    blocks = carray_init(blocks, TEXT_BLOCK);
+    common_parse_find_blocks(text, blocks);
+
+    if(arguments.blocks == 1)
+        error_unclosed_blocks(*blocks, name);
+
+    display_docgen_tags(*blocks, arguments.jobs);
+
+    carray_free(blocks, TEXT_BLOCK);
+    cstring_free(text);
+}
+
+int main(int argc, char **argv) {
+    int file_index = 0;
+    struct ProgramArguments arguments = parse_arguments(argc, argv);
+
+    if(arguments.file_count == 0)
+        extract_file(stdin, "the stdin", arguments);
+
+    /* Each file is given a FILE record, so a single compiler can tell
+     * the tags of one file apart from the next. */
+    for(file_index = 0; file_index < arguments.file_count; file_index++) {
+        FILE *source_file = fopen(arguments.files[file_index], "r");
+
+        LIBERROR_FILE_OPEN_FAILURE(source_file, arguments.files[file_index]);
+
+        printf(COMMON_PARSE_FILE_RECORD "%s\n", arguments.files[file_index]);
+        extract_file(source_file, arguments.files[file_index], arguments);
+        fclose(source_file);
+    }
 
-    display_docgen_tags(*stdin_lines);
-    
-    carray_free(stdin_lines, CSTRING);
+    free(arguments.files);
 
     return EXIT_SUCCESS;
 }
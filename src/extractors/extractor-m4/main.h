@@ -48,4 +48,36 @@
 /* Misc. information */
 #define PROGRAM_NAME    "docgen-extractor-c"
 
+#define TAG_RECORD_TYPE struct TagRecord
+#define TAG_RECORD_HEAP 1
+#define TAG_RECORD_FREE(record)
+
+/* The command line arguments for the program */
+struct ProgramArguments {
+    int jobs;
+    int blocks;
+    int file_count;
+    char **files;
+};
+
+/* A line with a docgen tag, found while scanning a chunk of the input */
+struct TagRecord {
+    int line_index;
+    int length;
+    const char *contents;
+};
+
+struct TagRecords {
+    int length;
+    int capacity;
+    struct TagRecord *contents;
+};
+
+/* The docgen blocks of the input that are scanned on one thread */
+struct ExtractionChunk {
+    struct TextBlock *blocks;
+    int block_count;
+    struct TagRecords *records;
+};
+
 #endif
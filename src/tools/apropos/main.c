@@ -0,0 +1,256 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Searches the index of manuals the backend writes with --index, so
+ * manuals can be found by name, or by what they are about, without
+ * reading every manual. Names are looked up by prefix with a binary
+ * search of the index, so a lookup stays fast however many manuals
+ * there are. Searching for a substring has to look at every line.
+ *
+ * Indexes written by separate runs of the backend can be merged into
+ * one with --merge.
+*/
+
+#include "../../docgen.h"
+
+#include "../../common/parsing/parsing.h"
+#include "../../common/index/index.h"
+
+#include "main.h"
+
+/* The help message, a line at a time, which keeps each string within
+ * the length C89 compilers have to support */
+static const char *help_message[] = {
+    "docgen-apropos [ --index INDEX | -i INDEX ] [ --substring | -s ] [ --paths | -p ] NAME...\n",
+    "docgen-apropos ( --merge INDEX | -m INDEX ) SHARD...\n",
+    "Search an index of manuals written by docgen-backend-manpage --index.\n",
+    "\n",
+    "Optional arguments:\n",
+    "   --index, -i INDEX     the index to search. defaults to " DEFAULT_INDEX_PATH "\n",
+    "   --substring, -s       list the manuals whose name or brief contains each NAME, rather than\n",
+    "                         the manuals whose name starts with it\n",
+    "   --paths, -p           list the path of each manual found, rather than its name and brief\n",
+    "   --merge, -m INDEX     merge the indexes given as SHARDs into INDEX\n",
+    NULL
+};
+
+struct ProgramArguments parse_arguments(int argc, char **argv) {
+    int argument_index = 0;
+    struct ProgramArguments arguments = {DEFAULT_INDEX_PATH, 0, 0, NULL, 0, NULL};
+    struct ArgparseParser parser = argparse_init(PROGRAM_NAME, argc, argv);
+
+    argparse_variable_arguments(parser);
+
+    /* These are the options we want to accept */
+    argparse_add_option(&parser, "-i", "--index", 1);
+    argparse_add_option(&parser, "-s", "--substring", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-p", "--paths", ARGPARSE_FLAG);
+    argparse_add_option(&parser, "-m", "--merge", 1);
+
+    /* Display the help message */
+    if(argparse_option_exists(parser, "-h") != 0 || argparse_option_exists(parser, "--help") != 0) {
+        int line_index = 0;
+
+        for(line_index = 0; help_message[line_index] != NULL; line_index++) {
+            fprintf(LIBERROR_STREAM, "%s", help_message[line_index]);
+        }
+
+        exit(1);
+    }
+
+    argparse_error(parser);
+
+    if(argparse_option_exists(parser, "-i") != 0)
+        arguments.index_path = argparse_get_option_parameter(parser, "-i", 0);
+    else if(argparse_option_exists(parser, "--index") != 0)
+        arguments.index_path = argparse_get_option_parameter(parser, "--index", 0);
+
+    if(argparse_option_exists(parser, "-s") != 0 || argparse_option_exists(parser, "--substring") != 0)
+        arguments.substring = 1;
+
+    if(argparse_option_exists(parser, "-p") != 0 || argparse_option_exists(parser, "--paths") != 0)
+        arguments.paths = 1;
+
+    if(argparse_option_exists(parser, "-m") != 0)
+        arguments.merge = argparse_get_option_parameter(parser, "-m", 0);
+    else if(argparse_option_exists(parser, "--merge") != 0)
+        arguments.merge = argparse_get_option_parameter(parser, "--merge", 0);
+
+    arguments.arguments = malloc(sizeof(*arguments.arguments) * (size_t) argc);
+
+    argparse_argument_variable_iter(parser, argument_index) {
+        arguments.arguments[arguments.argument_count] = argparse_get_index(parser, argument_index);
+        arguments.argument_count++;
+    }
+
+    if(arguments.argument_count == 0 && arguments.merge == NULL) {
+        fprintf(LIBERROR_STREAM, PROGRAM_NAME ": expected a name to search for\n");
+
+        exit(EXIT_FAILURE);
+    }
+
+    argparse_free(parser);
+
+    return arguments;
+}
+
+/* Load an index, exiting if the file is not one */
+struct CommonIndex load_index(const char *path) {
+    struct CommonIndex index;
+
+    if(common_index_load(&index, path) == 1)
+        return index;
+
+    fprintf(LIBERROR_STREAM, PROGRAM_NAME ": '%s' is not an index\n", path);
+    exit(EXIT_NOT_AN_INDEX);
+}
+
+/* Determine if a field of a line contains a string */
+int field_contains(struct CStringView field, const char *string) {
+    int offset = 0;
+    int length = (int) strlen(string);
+
+    for(offset = 0; offset + length <= field.length; offset++) {
+        if(strncmp(field.contents + offset, string, (size_t) length) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+void display_entry(struct CommonIndexEntry entry, struct ProgramArguments arguments) {
+    if(arguments.paths == 1) {
+        printf("%.*s\n", entry.path.length, entry.path.contents);
+
+        return;
+    }
+
+    printf("%.*s (%.*s) - %.*s\n", entry.name.length, entry.name.contents, entry.section.length, entry.section.contents,
+           entry.brief.length, entry.brief.contents);
+}
+
+/* Display each manual whose name starts with a prefix */
+int search_prefix(struct CommonIndex index, const char *prefix, struct ProgramArguments arguments) {
+    int found = 0;
+    int prefix_length = (int) strlen(prefix);
+    const char *line = common_index_find_prefix(index, prefix);
+
+    /* The manuals with the prefix are all next to each other */
+    while(line < common_index_end(index)) {
+        struct CommonIndexEntry entry;
+
+        line = common_index_read_entry(index, line, &entry);
+
+        if(entry.name.length < prefix_length || strncmp(entry.name.contents, prefix, (size_t) prefix_length) != 0)
+            break;
+
+        display_entry(entry, arguments);
+        found++;
+    }
+
+    return found;
+}
+
+/* Display each manual whose name or brief contains a string */
+int search_substring(struct CommonIndex index, const char *string, struct ProgramArguments arguments) {
+    int found = 0;
+    const char *line = common_index_start(index);
+
+    while(line < common_index_end(index)) {
+        struct CommonIndexEntry entry;
+
+        line = common_index_read_entry(index, line, &entry);
+
+        if(field_contains(entry.name, string) == 0 && field_contains(entry.brief, string) == 0)
+            continue;
+
+        display_entry(entry, arguments);
+        found++;
+    }
+
+    return found;
+}
+
+/* Merge the indexes of several runs of the backend into one */
+void merge_indexes(struct ProgramArguments arguments) {
+    int shard_index = 0;
+    struct CStrings *lines = NULL;
+
+    lines = carray_init(lines, CSTRING);
+
+    for(shard_index = 0; shard_index < arguments.argument_count; shard_index++) {
+        struct CommonIndex shard = load_index(arguments.arguments[shard_index]);
+
+        common_index_add_lines(lines, shard);
+        common_index_free(shard);
+    }
+
+    common_index_write(lines, arguments.merge);
+    carray_free(lines, CSTRING);
+}
+
+int main(int argc, char **argv) {
+    int found = 0;
+    int argument_index = 0;
+    struct CommonIndex index;
+    struct ProgramArguments arguments = parse_arguments(argc, argv);
+
+    if(arguments.merge != NULL) {
+        merge_indexes(arguments);
+        free(arguments.arguments);
+
+        return 0;
+    }
+
+    index = load_index(arguments.index_path);
+
+    for(argument_index = 0; argument_index < arguments.argument_count; argument_index++) {
+        if(arguments.substring == 1)
+            found += search_substring(index, arguments.arguments[argument_index], arguments);
+        else
+            found += search_prefix(index, arguments.arguments[argument_index], arguments);
+    }
+
+    common_index_free(index);
+    free(arguments.arguments);
+
+    if(found == 0)
+        return EXIT_NOTHING_FOUND;
+
+    return 0;
+}
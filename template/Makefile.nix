@@ -5,15 +5,21 @@ include(m4ke.m4)
 
 CC=cc
 PREFIX=/usr/local
+LDLIBS=-lpthread
+DOCFLAGS=--section 3
 OBJS=CONVERT_FILES(src, .c, .o)
 BINS=CONVERT_FILES(src, .c,, main\.c, 1)
 DEPS=CONVERT_FILES(src, .c, .o, main\.c)
+TESTS=CONVERT_FILES(tests, .c, .out)
 
 all: $(OBJS) $(BINS)
 
 clean:
 	rm -f $(OBJS)
 	rm -f $(BINS)
+	rm -f $(DOCS)
+	rm -f $(TESTS)
+	rm -rf tests/work
 
 install:
 	cp src/backends/manpage/main $(PREFIX)/bin/docgen-backend-manpage
@@ -21,12 +27,17 @@ install:
 	cp src/compilers/compiler-m4/main $(PREFIX)/bin/docgen-compiler-m4
 	cp src/extractors/extractor-c/main $(PREFIX)/bin/docgen-extractor-c
 	cp src/extractors/extractor-m4/main $(PREFIX)/bin/docgen-extractor-m4
+	cp src/tools/apropos/main $(PREFIX)/bin/docgen-apropos
+
+check: all $(TESTS)
+	./scripts/check.sh
 
 .SUFFIXES:
 
 dnl Declare all implicit rules
 NEW_IMPLICIT_RULE(.c, .o, `	$(CC) -c $1 -o $2')
-NEW_IMPLICIT_RULE(.o,, `	$(CC) $1 $(DEPS) -o $2')
+NEW_IMPLICIT_RULE(.o,, `	$(CC) $1 $(DEPS) -o $2 $(LDLIBS)')
+NEW_IMPLICIT_RULE(.c, .out, `	$(CC) $1 -o $2')
 
 dnl Build all the base objects
 NEW_RULE(src/compilers/compiler-c/main, .c, .o)
@@ -34,23 +45,71 @@ NEW_RULE(src/compilers/compiler-c/embeds/structures, .c, .o)
 NEW_RULE(src/compilers/compiler-c/embeds/functions, .c, .o)
 NEW_RULE(src/compilers/compiler-c/embeds/macro_functions, .c, .o)
 NEW_RULE(src/compilers/compiler-c/embeds/constants, .c, .o)
+NEW_RULE(src/compilers/compiler-c/embeds/requests, .c, .o)
 NEW_RULE(src/compilers/compiler-m4/main, .c, .o)
 NEW_RULE(src/compilers/compiler-m4/embeds/macro_functions, .c, .o)
 NEW_RULE(src/backends/manpage/main, .c, .o)
 NEW_RULE(src/common/errors/errors, .c, .o)
 NEW_RULE(src/common/parsing/parsing, .c, .o)
+NEW_RULE(src/common/intern/intern, .c, .o)
+NEW_RULE(src/common/index/index, .c, .o)
 NEW_RULE(src/extractors/extractor-c/main, .c, .o)
 NEW_RULE(src/extractors/extractor-m4/main, .c, .o)
 NEW_RULE(src/deps/cstring/cstring, .c, .o)
 NEW_RULE(src/deps/argparse/argparse, .c, .o)
 NEW_RULE(src/deps/argparse/extract, .c, .o)
 NEW_RULE(src/deps/argparse/ap_inter, .c, .o)
+NEW_RULE(src/tools/apropos/main, .c, .o)
 
 dnl Build the final binaries, which rely on the dependencies
-NEW_RULE(src/extractors/extractor-c/main, .o, )
-NEW_RULE(src/extractors/extractor-m4/main, .o, )
-NEW_RULE(src/compilers/compiler-c/main, .o, )
-NEW_RULE(src/compilers/compiler-m4/main, .o, )
-NEW_RULE(src/backends/manpage/main, .o, )
+NEW_RULE(src/extractors/extractor-c/main, .o, , $(DEPS))
+NEW_RULE(src/extractors/extractor-m4/main, .o, , $(DEPS))
+NEW_RULE(src/compilers/compiler-c/main, .o, , $(DEPS))
+NEW_RULE(src/compilers/compiler-m4/main, .o, , $(DEPS))
+NEW_RULE(src/backends/manpage/main, .o, , $(DEPS))
+NEW_RULE(src/tools/apropos/main, .o, , $(DEPS))
+
+dnl Build the tests, which run the binaries from scripts/check.sh
+NEW_RULE(tests/archive, .c, .out, tests/common.h)
+NEW_RULE(tests/backend_stream, .c, .out, tests/common.h)
+NEW_RULE(tests/blocks, .c, .out, tests/common.h)
+NEW_RULE(tests/check, .c, .out, tests/common.h)
+NEW_RULE(tests/demand, .c, .out, tests/common.h)
+NEW_RULE(tests/depfile, .c, .out, tests/common.h)
+NEW_RULE(tests/embeds, .c, .out, tests/common.h)
+NEW_RULE(tests/files, .c, .out, tests/common.h)
+NEW_RULE(tests/formats, .c, .out, tests/common.h)
+NEW_RULE(tests/index, .c, .out, tests/common.h)
+NEW_RULE(tests/jobs, .c, .out, tests/common.h)
+NEW_RULE(tests/lines, .c, .out, src/common/errors/errors.c src/common/errors/errors.h)
+NEW_RULE(tests/only, .c, .out, tests/common.h)
+NEW_RULE(tests/pipeline, .c, .out, tests/common.h)
+NEW_RULE(tests/serve, .c, .out, tests/common.h)
+NEW_RULE(tests/snapshot, .c, .out, tests/common.h)
+NEW_RULE(tests/source, .c, .out, tests/common.h)
+NEW_RULE(tests/stream, .c, .out, tests/common.h)
+
+dnl Document sources, writing a dependency file for each one
+dnl which lists the manuals it produced. Add the sources to
+dnl document with NEW_DOCUMENTATION_RULE(name, .h, .d, $(DOCBINS))
+dnl The compiler runs on its own first, so a source it fails on
+dnl stops the rule before the backend writes a dependency file.
+NEW_IMPLICIT_RULE(.h, .d, `	mkdir -p doc
+	src/compilers/compiler-c/main --source $1 > $2.in || (rm -f $2.in; exit 1)
+	src/backends/manpage/main $(DOCFLAGS) --source $1 --depfile $2 < $2.in || (rm -f $2.in; exit 1)
+	rm -f $2.in')
+NEW_IMPLICIT_RULE(.m4, .d, `	mkdir -p doc
+	src/compilers/compiler-m4/main --source $1 > $2.in || (rm -f $2.in; exit 1)
+	src/backends/manpage/main $(DOCFLAGS) --source $1 --depfile $2 < $2.in || (rm -f $2.in; exit 1)
+	rm -f $2.in')
+
+DOCBINS=src/compilers/compiler-c/main src/compilers/compiler-m4/main src/backends/manpage/main
+DOCS=DOCUMENTATION_FILES
+
+docs: $(DOCS)
+
+dnl The dependency files make each source depend on the manuals
+dnl it produced, so a manual that was removed is written again
+-include $(DOCS)
 
-.PHONY: all clean install
+.PHONY: all clean install check docs
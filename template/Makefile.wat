@@ -11,6 +11,7 @@ include(m4ke.m4)
 
 CC=wcc386
 LD=wlink
+DOCFLAGS=--section 3
 OBJS=CONVERT_FILES(src, .c, .obj)
 BINS=CONVERT_FILES(src, .c, .exe, main\.c, 1)
 DEPS=CONVERT_FILES_TO_COMMA(src, .c, .obj, main\.c)
@@ -20,6 +21,7 @@ all: $(OBJS) $(BINS)
 clean: .SYMBOLIC
 	for %f in ($(OBJS)) do del %f
 	for %f in ($(BINS)) do del %f
+	for %f in ($(DOCS)) do del %f
 
 .SUFFIXES:
 
@@ -33,17 +35,21 @@ NEW_RULE(src\compilers\compiler-c\embeds\structures, .c, .obj)
 NEW_RULE(src\compilers\compiler-c\embeds\functions, .c, .obj)
 NEW_RULE(src\compilers\compiler-c\embeds\macro_functions, .c, .obj)
 NEW_RULE(src\compilers\compiler-c\embeds\constants, .c, .obj)
+NEW_RULE(src\compilers\compiler-c\embeds\requests, .c, .obj)
 NEW_RULE(src\compilers\compiler-m4\main, .c, .obj)
 NEW_RULE(src\compilers\compiler-m4\embeds\macro_functions, .c, .obj)
 NEW_RULE(src\backends\manpage\main, .c, .obj)
 NEW_RULE(src\common\errors\errors, .c, .obj)
 NEW_RULE(src\common\parsing\parsing, .c, .obj)
+NEW_RULE(src\common\intern\intern, .c, .obj)
+NEW_RULE(src\common\index\index, .c, .obj)
 NEW_RULE(src\extractors\extractor-c\main, .c, .obj)
 NEW_RULE(src\extractors\extractor-m4\main, .c, .obj)
 NEW_RULE(src\deps\cstring\cstring, .c, .obj)
 NEW_RULE(src\deps\argparse\argparse, .c, .obj)
 NEW_RULE(src\deps\argparse\extract, .c, .obj)
 NEW_RULE(src\deps\argparse\ap_inter, .c, .obj)
+NEW_RULE(src\tools\apropos\main, .c, .obj)
 
 dnl Build the final binaries, which rely on the dependencies
 NEW_RULE(src\extractors\extractor-c\main, .obj, .exe)
@@ -51,3 +57,23 @@ NEW_RULE(src\extractors\extractor-m4\main, .obj, .exe)
 NEW_RULE(src\compilers\compiler-c\main, .obj, .exe)
 NEW_RULE(src\compilers\compiler-m4\main, .obj, .exe)
 NEW_RULE(src\backends\manpage\main, .obj, .exe)
+NEW_RULE(src\tools\apropos\main, .obj, .exe)
+
+dnl Document sources, writing a dependency file for each one
+dnl which lists the manuals it produced. Add the sources to
+dnl document with NEW_DOCUMENTATION_RULE(name, .h, .d, $(DOCBINS))
+dnl The compiler runs on its own first, so a source it fails on
+dnl stops the rule before the backend writes a dependency file.
+NEW_IMPLICIT_RULE(.h, .d, `	if not exist doc mkdir doc
+	src\compilers\compiler-c\main.exe --source $1 > $2.in
+	src\backends\manpage\main.exe $(DOCFLAGS) --source $1 --depfile $2 < $2.in
+	del $2.in')
+NEW_IMPLICIT_RULE(.m4, .d, `	if not exist doc mkdir doc
+	src\compilers\compiler-m4\main.exe --source $1 > $2.in
+	src\backends\manpage\main.exe $(DOCFLAGS) --source $1 --depfile $2 < $2.in
+	del $2.in')
+
+DOCBINS=src\compilers\compiler-c\main.exe src\compilers\compiler-m4\main.exe src\backends\manpage\main.exe
+DOCS=DOCUMENTATION_FILES
+
+docs: .SYMBOLIC $(DOCS)
@@ -56,3 +56,34 @@ dnl $3 the output extension
 dnl $4 extra dependencies
 define(`NEW_RULE', `$1$3: $1$2 $4
 translit(IMPLICIT_RULE$2$3, ., _)($1$2, $1$3)')
+
+dnl The dependency files of every documentation rule
+dnl declared so far, which the rules build as a side
+dnl effect of generating their manuals.
+define(`DOCUMENTATION_FILES', `')
+
+dnl Create a rule that documents a source file, using the
+dnl implicit rule declared for its extension and the
+dnl dependency file extension. The target of the rule is
+dnl the dependency file the backend writes, which maps the
+dnl source to each manual generated from it, so only the
+dnl manuals of sources that changed are regenerated.
+dnl
+dnl $1 the name of the file, without extensions
+dnl $2 the source extension
+dnl $3 the dependency file extension
+dnl $4 extra dependencies
+dnl
+dnl Watcom has no -include, so each dependency file is
+dnl included here, once it exists.
+ifdef(`M4KE_DOS',
+    `define(`NEW_DOCUMENTATION_RULE', `define(`DOCUMENTATION_FILES', defn(`DOCUMENTATION_FILES')` $1$2$3')dnl
+$1$2$3: $1$2 $4
+translit(IMPLICIT_RULE$2$3, ., _)($1$2, $1$2$3)
+!ifexist $1$2$3
+!include $1$2$3
+!endif')',
+    `define(`NEW_DOCUMENTATION_RULE', `define(`DOCUMENTATION_FILES', defn(`DOCUMENTATION_FILES')` $1$2$3')dnl
+$1$2$3: $1$2 $4
+translit(IMPLICIT_RULE$2$3, ., _)($1$2, $1$2$3)')'
+)
@@ -0,0 +1,88 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Streaming manuals, with the --stream option of the backend. A manual is
+ * written as soon as the embeds it requests have been read, which must
+ * give the same manuals as building them once the whole input is read,
+ * no matter where in the input the embeds are, or how many groups and
+ * embeds share a name.
+*/
+
+#include "common.h"
+
+/* Write the manuals of a compiled input as they are streamed */
+#define STREAMED_MANUALS(directory, input) \
+    "mkdir -p " directory "/doc && cd " directory " && " BACKEND " --stream < ../" input
+
+int main(void) {
+    assert(WORK("backend-stream") == 0);
+    assert(RUN(IN("backend-stream") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+
+    /* Every embed after the groups that request it */
+    assert(RUN(IN("backend-stream") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("backend-stream") MANUALS("batch", "batch.out")) == 0);
+    assert(RUN(IN("backend-stream") STREAMED_MANUALS("stream", "batch.out")) == 0);
+    assert(RUN(IN("backend-stream") "diff -r batch stream") == 0);
+
+    /* Each embed right after the block it is in */
+    assert(RUN(IN("backend-stream") COMPILER_C " --stream < point.ex > stream.out") == 0);
+    assert(RUN(IN("backend-stream") STREAMED_MANUALS("both", "stream.out")) == 0);
+    assert(RUN(IN("backend-stream") "diff -r batch both") == 0);
+
+    /* The manuals requesting an embed that is never read are still
+     * written once the input ends, and the embed is reported */
+    assert(RUN(IN("backend-stream") "sed '/^START_EMBED MAX_POINTS$/,/^END_EMBED$/d' batch.out > missing.out") == 0);
+    assert(RUN(IN("backend-stream") MANUALS("missing-batch", "missing.out")) == 0);
+    assert(RUN(IN("backend-stream") STREAMED_MANUALS("missing-stream", "missing.out") " 2> ../missing.err") == 0);
+    assert(RUN(IN("backend-stream") "diff -r missing-batch missing-stream") == 0);
+    assert(RUN(IN("backend-stream") "grep \"requested embed 'MAX_POINTS'\" missing.err > /dev/null") == 0);
+
+    /* Groups and embeds that share a name, over and over in a large input.
+     * Only the first group and the first embed with each name are used,
+     * however long a group waits for its embeds */
+    assert(RUN(IN("backend-stream") COPIES(500, INPUT("duplicates.h") " " INPUT("point.h")) " > many.h") == 0);
+    assert(RUN(IN("backend-stream") EXTRACTOR_C " < many.h | " COMPILER_C " > many.out") == 0);
+    assert(RUN(IN("backend-stream") MANUALS("many-batch", "many.out")) == 0);
+    assert(RUN(IN("backend-stream") STREAMED_MANUALS("many-stream", "many.out")) == 0);
+    assert(RUN(IN("backend-stream") "diff -r many-batch many-stream") == 0);
+    assert(RUN(IN("backend-stream") "grep 'the first area' many-stream/doc/area.3 > /dev/null") == 0);
+    assert(RUN(IN("backend-stream") "test `grep -c 'struct Shape {' many-stream/doc/area.3` -eq 1") == 0);
+    assert(RUN(IN("backend-stream") "test `grep -c 'int sides;' many-stream/doc/area.3` -eq 1") == 0);
+
+    return 0;
+}
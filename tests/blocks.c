@@ -0,0 +1,75 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Reporting unclosed docgen blocks from the extractors, with --blocks.
+ * Input whose blocks are all closed is extracted just the same as without
+ * it, and a block that is never closed is reported instead of extracted.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("blocks") == 0);
+
+    /* The same tags as without --blocks */
+    assert(RUN(IN("blocks") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+    assert(RUN(IN("blocks") EXTRACTOR_C " --blocks < " INPUT("point.h") " > blocks.ex") == 0);
+    assert(RUN(IN("blocks") "cmp point.ex blocks.ex") == 0);
+
+    assert(RUN(IN("blocks") EXTRACTOR_M4 " < " INPUT("rules.m4") " > rules.ex") == 0);
+    assert(RUN(IN("blocks") EXTRACTOR_M4 " --blocks < " INPUT("rules.m4") " > blocks-m4.ex") == 0);
+    assert(RUN(IN("blocks") "cmp rules.ex blocks-m4.ex") == 0);
+
+    /* Tags which only start with the name of a block tag do not start
+     * or end a block */
+    assert(RUN(IN("blocks") "printf '/*\\n * @docgen_starting soon\\n * @docgen_endx\\n*/\\n' > prefixed.h") == 0);
+    assert(RUN(IN("blocks") "cat " INPUT("point.h") " >> prefixed.h") == 0);
+    assert(RUN(IN("blocks") EXTRACTOR_C " --blocks < prefixed.h | " COMPILER_C " > prefixed.out") == 0);
+    assert(RUN(IN("blocks") COMPILER_C " < point.ex > point.out") == 0);
+    assert(RUN(IN("blocks") "cmp point.out prefixed.out") == 0);
+
+    /* A block that is never closed, in the stdin, in one of several
+     * files, and when the input is scanned on several threads */
+    assert(EXITS_WITH(IN("blocks") EXTRACTOR_C " --blocks < " INPUT("unclosed.h") " > /dev/null 2> unclosed.err", 5) == 0);
+    assert(RUN(IN("blocks") "grep 'line 11 of the stdin is never closed' unclosed.err > /dev/null") == 0);
+    assert(EXITS_WITH(IN("blocks") EXTRACTOR_C " --blocks " INPUT("point.h") " " INPUT("unclosed.h") " > /dev/null 2> /dev/null", 5) == 0);
+    assert(EXITS_WITH(IN("blocks") EXTRACTOR_C " --blocks --jobs 2 < " INPUT("unclosed.h") " > /dev/null 2> /dev/null", 5) == 0);
+    assert(EXITS_WITH(IN("blocks") "printf 'dnl @docgen_start\\ndnl @type: macro\\n' | " EXTRACTOR_M4 " --blocks > /dev/null 2> /dev/null", 5) == 0);
+
+    return 0;
+}
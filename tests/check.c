@@ -0,0 +1,66 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Validating without compiling, with --check. Nothing is written to the
+ * stdout, and invalid tags exit with the same code as compiling does.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("check") == 0);
+
+    /* The @author at the top of point.h and rules.m4 is outside of any
+     * docgen block, so it is not a tag */
+    assert(RUN(IN("check") COMPILER_C " --check " INPUT("point.h") " > check.out") == 0);
+    assert(RUN(IN("check") COMPILER_M4 " --check " INPUT("rules.m4") " >> check.out") == 0);
+    assert(RUN(IN("check") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " --check >> check.out") == 0);
+    assert(RUN(IN("check") "test ! -s check.out") == 0);
+
+    /* An unrecognized tag, whether it is in the only file, in one of
+     * several, or in the stdin */
+    assert(EXITS_WITH(IN("check") COMPILER_C " --check " INPUT("broken.h") " 2> broken.err", 11) == 0);
+    assert(RUN(IN("check") "grep \"unrecognized tag '@bogus'\" broken.err > /dev/null") == 0);
+    assert(EXITS_WITH(IN("check") COMPILER_C " --check " INPUT("point.h") " " INPUT("broken.h") " 2> /dev/null", 11) == 0);
+    assert(EXITS_WITH(IN("check") EXTRACTOR_C " < " INPUT("broken.h") " | " COMPILER_C " --check 2> /dev/null", 11) == 0);
+
+    /* Files can only be given to check */
+    assert(EXITS_WITH(IN("check") COMPILER_C " " INPUT("point.h") " 2> /dev/null", 1) == 0);
+
+    return 0;
+}
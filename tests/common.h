@@ -0,0 +1,89 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CWARE_DOCGEN_TESTS_COMMON_H
+#define CWARE_DOCGEN_TESTS_COMMON_H
+
+#include <assert.h>
+#include <stdlib.h>
+
+/*
+ * Each test runs the programs built by Makefile.nix through the shell,
+ * from the root of the repository, which is where scripts/check.sh runs
+ * them from. The root is kept in $ROOT, so that a command can move into
+ * a directory of its own under tests/work, and still find the programs
+ * and the inputs.
+*/
+#define RUN(command) system("ROOT=`pwd`; " command)
+
+/* Run a command inside a directory of tests/work */
+#define IN(directory) "cd tests/work/" directory " || exit 99; "
+
+/* Make an empty directory in tests/work */
+#define WORK(directory) RUN("rm -rf tests/work/" directory " && mkdir -p tests/work/" directory)
+
+/* Write the manuals of a compiled input, which sits next to a directory,
+ * into the doc/ directory of that directory. Two ways of building the same
+ * manuals are compared by comparing their directories. */
+#define MANUALS(directory, input) \
+    "mkdir -p " directory "/doc && cd " directory " && " BACKEND " < ../" input
+
+/* Whether two compiled inputs give the same manuals, written as MANUALS
+ * writes them */
+#define SAME_MANUALS(first, first_input, second, second_input) \
+    "(" MANUALS(first, first_input) ") && (" MANUALS(second, second_input) ") && diff -r " first " " second
+
+/* Write some inputs into the stdout, one after another, a number of
+ * times over, which makes an input as large as a test needs */
+#define COPIES(count, inputs) \
+    "copy=0; while [ $copy -lt " #count " ]; do cat " inputs "; copy=$((copy + 1)); done"
+
+/* Whether a command exits with the exit code given */
+#define EXITS_WITH(command, code) RUN(command "; test $? -eq " #code)
+
+/* The programs under test */
+#define EXTRACTOR_C     "\"$ROOT/src/extractors/extractor-c/main\""
+#define EXTRACTOR_M4    "\"$ROOT/src/extractors/extractor-m4/main\""
+#define COMPILER_C      "\"$ROOT/src/compilers/compiler-c/main\""
+#define COMPILER_M4     "\"$ROOT/src/compilers/compiler-m4/main\""
+#define BACKEND         "\"$ROOT/src/backends/manpage/main\" --section 3 --title Tests --date today"
+#define APROPOS         "\"$ROOT/src/tools/apropos/main\""
+
+/* The inputs of the tests */
+#define INPUT(name)     "\"$ROOT/tests/inputs/" name "\""
+
+#endif
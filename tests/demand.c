@@ -0,0 +1,78 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Compiling only the embeds that are requested, with --demand. Embeds
+ * nothing requests are left out, which must not change any manual.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("demand") == 0);
+    assert(RUN(IN("demand") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+
+    /* The same manuals as compiling every embed */
+    assert(RUN(IN("demand") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("demand") COMPILER_C " --demand < point.ex > demand.out") == 0);
+    assert(RUN(IN("demand") SAME_MANUALS("batch", "batch.out", "demand", "demand.out")) == 0);
+
+    /* Without the embeds of Hidden and UNUSED_LIMIT, which nothing
+     * requests */
+    assert(RUN(IN("demand") "grep 'START_EMBED Point' demand.out > /dev/null") == 0);
+    assert(RUN(IN("demand") "grep 'START_EMBED Hidden' demand.out") != 0);
+    assert(RUN(IN("demand") "grep 'START_EMBED UNUSED_LIMIT' demand.out") != 0);
+
+    /* And the same whichever way the input is read or compiled */
+    assert(RUN(IN("demand") COMPILER_C " --demand --source " INPUT("point.h") " > source.out") == 0);
+    assert(RUN(IN("demand") COMPILER_C " --demand --jobs 3 < point.ex > jobs.out") == 0);
+    assert(RUN(IN("demand") "cmp demand.out source.out && cmp demand.out jobs.out") == 0);
+
+    /* A block can request an embed that comes after it */
+    assert(EXITS_WITH(IN("demand") COMPILER_C " --demand --stream < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("demand") COMPILER_C " --demand --pipeline < point.ex 2> /dev/null", 1) == 0);
+
+    /* Every macro requests its own embed, so the m4 compiler leaves
+     * nothing out */
+    assert(RUN(IN("demand") EXTRACTOR_M4 " < " INPUT("rules.m4") " > rules.ex") == 0);
+    assert(RUN(IN("demand") COMPILER_M4 " < rules.ex > rules.out") == 0);
+    assert(RUN(IN("demand") COMPILER_M4 " --demand < rules.ex > rules-demand.out") == 0);
+    assert(RUN(IN("demand") "cmp rules.out rules-demand.out") == 0);
+    assert(EXITS_WITH(IN("demand") COMPILER_M4 " --demand --stream < rules.ex 2> /dev/null", 1) == 0);
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Writing a make rule for the manuals of a source, with --depfile. Each
+ * manual is listed once, and a make which includes the rule writes the
+ * manuals again once one of them is removed.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("depfile") == 0);
+    assert(RUN(IN("depfile") "cp " INPUT("point.h") " point.h") == 0);
+    assert(RUN(IN("depfile") EXTRACTOR_C " < point.h | " COMPILER_C " > point.out") == 0);
+    assert(RUN(IN("depfile") "mkdir -p doc && " BACKEND " --source point.h --depfile point.d < point.out") == 0);
+
+    /* The dependency file depends on each manual, and each manual on the
+     * source, even the ones the source defines twice */
+    assert(RUN(IN("depfile") "head -n 1 point.d | grep -q '^point.d: point.h .*doc/Point.3'") == 0);
+    assert(RUN(IN("depfile") "tail -n 1 point.d | grep -q 'doc/Point.3.*: point.h$'") == 0);
+    assert(RUN(IN("depfile") "test `head -n 1 point.d | grep -o 'doc/Hidden.3' | wc -l` -eq 1") == 0);
+
+    /* A removed manual is written again */
+    assert(RUN(IN("depfile") "printf 'point.d: point.h\\n\\t%s --source point.h --depfile point.d < point.out\\n-include point.d\\n' "
+                             "\"$ROOT/src/backends/manpage/main --section 3 --title Tests --date today\" > Makefile") == 0);
+    assert(RUN(IN("depfile") "make -s point.d") == 0);
+    assert(RUN(IN("depfile") "rm doc/Point.3 && make -s point.d && test -f doc/Point.3") == 0);
+
+    return 0;
+}
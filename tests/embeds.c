@@ -0,0 +1,88 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Saving the embeds of a file with --write-embeds, and embedding them in
+ * the manuals of another file with --embeds. Writing a database with the
+ * --embeds of an older one keeps the older embeds, unless the input has
+ * an embed of the same name. Only the first embed of each name is kept.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("embeds") == 0);
+    assert(RUN(IN("embeds") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " > point.out") == 0);
+    assert(RUN(IN("embeds") EXTRACTOR_C " < " INPUT("uses.h") " | " COMPILER_C " > uses.out") == 0);
+    assert(RUN(IN("embeds") EXTRACTOR_C " < " INPUT("moved.h") " | " COMPILER_C " > moved.out") == 0);
+
+    /* Only the database is written */
+    assert(RUN(IN("embeds") BACKEND " --write-embeds point.db < point.out") == 0);
+    assert(RUN(IN("embeds") "test -s point.db && test `ls | wc -l` -eq 4") == 0);
+
+    /* The embeds of another file are found in the database */
+    assert(RUN(IN("embeds") MANUALS("uses", "uses.out") " --embeds ../point.db") == 0);
+    assert(RUN(IN("embeds") "grep -q '^#define MAX_POINTS 100$' uses/doc/point_scale.3") == 0);
+    assert(RUN(IN("embeds") "grep -q '^/\\* a point in space \\*/$' uses/doc/point_scale.3") == 0);
+    assert(RUN(IN("embeds") "grep -q '^    int x;$' uses/doc/point_scale.3") == 0);
+
+    /* An embed of the input replaces the one in the database */
+    assert(RUN(IN("embeds") BACKEND " --embeds point.db --write-embeds moved.db < moved.out") == 0);
+    assert(RUN(IN("embeds") MANUALS("moved", "uses.out") " --embeds ../moved.db") == 0);
+    assert(RUN(IN("embeds") "grep -q '^/\\* a point in three dimensions \\*/$' moved/doc/point_scale.3") == 0);
+    assert(RUN(IN("embeds") "grep -q '^    int z;$' moved/doc/point_scale.3") == 0);
+    assert(RUN(IN("embeds") "grep -q 'int x;' moved/doc/point_scale.3") != 0);
+    assert(RUN(IN("embeds") "grep -q '^#define MAX_POINTS 100$' moved/doc/point_scale.3") == 0);
+
+    /* The first of two embeds with the same name */
+    assert(RUN(IN("embeds") EXTRACTOR_C " < " INPUT("duplicates.h") " | " COMPILER_C " > duplicates.out") == 0);
+    assert(RUN(IN("embeds") BACKEND " --write-embeds shapes.db < duplicates.out") == 0);
+    assert(RUN(IN("embeds") "sed 's/@embed: Point/@embed: Shape/' " INPUT("uses.h") " | " EXTRACTOR_C " | " COMPILER_C " > shape.out") == 0);
+    assert(RUN(IN("embeds") MANUALS("shape", "shape.out") " --embeds ../shapes.db") == 0);
+    assert(RUN(IN("embeds") "grep -q 'the first shape' shape/doc/point_scale.3") == 0);
+    assert(RUN(IN("embeds") "grep -q 'the second shape' shape/doc/point_scale.3") != 0);
+
+    /* Nothing else that would be written is */
+    assert(EXITS_WITH(IN("embeds") BACKEND " --write-embeds other.db --index index < point.out 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("embeds") BACKEND " --write-embeds other.db --source point.h --depfile point.d < point.out 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("embeds") BACKEND " --write-embeds other.db --write-snapshot point.snap < point.out 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("embeds") BACKEND " --write-embeds other.db --archive point.ar < point.out 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("embeds") BACKEND " --write-embeds other.db --formats md < point.out 2> /dev/null", 1) == 0);
+    assert(RUN(IN("embeds") "test ! -f other.db && test ! -f index && test ! -f point.d") == 0);
+
+    return 0;
+}
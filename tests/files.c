@@ -0,0 +1,72 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Extracting and compiling several files at once. The extractor starts
+ * the tags of each file with a FILE record, which must give the same
+ * output as extracting and compiling each file on its own, and make the
+ * compiler report errors by the file and line they are on.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("files") == 0);
+    assert(RUN(IN("files") "cp " INPUT("point.h") " " INPUT("duplicates.h") " " INPUT("broken.h") " " INPUT("rules.m4") " .") == 0);
+
+    /* A record before the tags of each file */
+    assert(RUN(IN("files") EXTRACTOR_C " point.h duplicates.h > both.ex") == 0);
+    assert(RUN(IN("files") "test `grep -c '^FILE ' both.ex` -eq 2") == 0);
+    assert(RUN(IN("files") "head -n 1 both.ex | grep -q '^FILE point.h$'") == 0);
+
+    /* The same output as compiling each file on its own */
+    assert(RUN(IN("files") COMPILER_C " < both.ex > both.out") == 0);
+    assert(RUN(IN("files") "(" EXTRACTOR_C " < point.h | " COMPILER_C "; " EXTRACTOR_C " < duplicates.h | " COMPILER_C ") > each.out") == 0);
+    assert(RUN(IN("files") "cmp both.out each.out") == 0);
+
+    assert(RUN(IN("files") EXTRACTOR_M4 " rules.m4 rules.m4 | " COMPILER_M4 " > both-m4.out") == 0);
+    assert(RUN(IN("files") "(" EXTRACTOR_M4 " < rules.m4 | " COMPILER_M4 "; " EXTRACTOR_M4 " < rules.m4 | " COMPILER_M4 ") > each-m4.out") == 0);
+    assert(RUN(IN("files") "cmp both-m4.out each-m4.out") == 0);
+
+    /* An error in the second file is reported on its own line of that file */
+    assert(EXITS_WITH(IN("files") EXTRACTOR_C " point.h broken.h | " COMPILER_C " > /dev/null 2> broken.err", 11) == 0);
+    assert(RUN(IN("files") "grep \"unrecognized tag '@bogus' on line broken.h:15$\" broken.err > /dev/null") == 0);
+    assert(EXITS_WITH(IN("files") EXTRACTOR_C " point.h broken.h | " COMPILER_C " --stream > /dev/null 2> broken-stream.err", 11) == 0);
+    assert(RUN(IN("files") "cmp broken.err broken-stream.err") == 0);
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Writing manuals in several formats at once, with --formats. The manual
+ * pages are the same as when they are the only format, the HTML and the
+ * Markdown pages are the same whether they are streamed or not, and the
+ * formatting of a synopsis survives in each of them.
+*/
+
+#include "common.h"
+
+/* Write the manuals of a compiled input in a list of formats */
+#define FORMATTED_MANUALS(directory, input, formats) \
+    "mkdir -p " directory "/doc && cd " directory " && " BACKEND " --formats " formats " < ../" input
+
+int main(void) {
+    assert(WORK("formats") == 0);
+    assert(RUN(IN("formats") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " > point.out") == 0);
+
+    /* The same manual pages as writing only them */
+    assert(RUN(IN("formats") MANUALS("man", "point.out")) == 0);
+    assert(RUN(IN("formats") FORMATTED_MANUALS("all", "point.out", "man,html,md")) == 0);
+    assert(RUN(IN("formats") "diff -r -x '*.html' -x '*.md' man all") == 0);
+
+    /* The same pages in every format when streamed */
+    assert(RUN(IN("formats") FORMATTED_MANUALS("stream", "point.out", "man,html,md --stream")) == 0);
+    assert(RUN(IN("formats") "diff -r all stream") == 0);
+
+    /* Bold and italics do not run into each other or into escapes, and
+     * indented lines keep their indentation */
+    assert(RUN(IN("formats") "grep -F '<i>a</i>,<b> struct Point</b> <i>b</i>' all/doc/point_add.3.md > /dev/null") == 0);
+    assert(RUN(IN("formats") "grep -F '\\**' all/doc/point_add.3.md") != 0);
+    assert(RUN(IN("formats") "grep -F '&nbsp;&nbsp;&nbsp;&nbsp;int x;' all/doc/point_add.3.md > /dev/null") == 0);
+    assert(RUN(IN("formats") "grep -F '&nbsp;&nbsp;&nbsp;&nbsp;int x;<br>' all/doc/point_add.3.html > /dev/null") == 0);
+
+    /* Only the formats there are */
+    assert(EXITS_WITH(IN("formats") FORMATTED_MANUALS("unknown", "point.out", "man,pdf") " 2> /dev/null", 1) == 0);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Writing an index of the manuals with --index, and searching it with
+ * docgen-apropos. Names are found by their prefix, or with --substring
+ * by any part of their name or brief, and indexes written by different
+ * runs of the backend can be merged into one.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("index") == 0);
+    assert(RUN(IN("index") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " > point.out") == 0);
+    assert(RUN(IN("index") EXTRACTOR_C " < " INPUT("uses.h") " | " COMPILER_C " > uses.out") == 0);
+
+    /* A line for each manual, even one that is documented twice */
+    assert(RUN(IN("index") MANUALS("point", "point.out") " --index doc/index") == 0);
+    assert(RUN(IN("index") "head -n 1 point/doc/index | grep -q '^DOCGEN INDEX 1$'") == 0);
+    assert(RUN(IN("index") "test `grep -c '^Hidden' point/doc/index` -eq 1") == 0);
+    assert(RUN(IN("index") "test `sed 1d point/doc/index | wc -l` -eq `ls point/doc/*.3 | wc -l`") == 0);
+
+    /* Streaming the manuals writes the same index */
+    assert(RUN(IN("index") MANUALS("stream", "point.out") " --stream --index doc/index") == 0);
+    assert(RUN(IN("index") "cmp point/doc/index stream/doc/index") == 0);
+
+    /* Names are found by their prefix, and their case */
+    assert(RUN(IN("index") APROPOS " --index point/doc/index point > found") == 0);
+    assert(RUN(IN("index") "printf 'point_add (3) - add two points\\n' | cmp - found") == 0);
+    assert(RUN(IN("index") APROPOS " --index point/doc/index --paths Point > found") == 0);
+    assert(RUN(IN("index") "printf 'doc/Point.3\\n' | cmp - found") == 0);
+
+    /* Or by any part of their name or brief */
+    assert(RUN(IN("index") APROPOS " --index point/doc/index --substring nobody > found") == 0);
+    assert(RUN(IN("index") "printf 'Hidden (3) - a structure nobody embeds\\n"
+                            "UNUSED_LIMIT (3) - a constant nobody embeds\\n' | cmp - found") == 0);
+
+    /* Finding nothing is an error */
+    assert(EXITS_WITH(IN("index") APROPOS " --index point/doc/index point_sub > found", 3) == 0);
+    assert(RUN(IN("index") "test ! -s found") == 0);
+
+    /* Merging the indexes of two runs */
+    assert(RUN(IN("index") MANUALS("uses", "uses.out") " --index doc/index") == 0);
+    assert(RUN(IN("index") APROPOS " --merge merged point/doc/index uses/doc/index") == 0);
+    assert(RUN(IN("index") "(echo 'DOCGEN INDEX 1'; (sed 1d point/doc/index; sed 1d uses/doc/index) | LC_ALL=C sort) | cmp - merged") == 0);
+    assert(RUN(IN("index") APROPOS " --index merged point > found") == 0);
+    assert(RUN(IN("index") "printf 'point_add (3) - add two points\\n"
+                            "point_scale (3) - scale a point\\n' | cmp - found") == 0);
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: FIRST
+ * @brief: a constant before the broken block
+ * @value: 1
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: function
+ * @name: broken
+ * @brief: a function with a tag nothing knows
+ * @bogus: x
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: LAST
+ * @brief: a constant after the broken block
+ * @value: 2
+ * @docgen_end
+*/
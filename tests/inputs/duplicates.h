@@ -0,0 +1,53 @@
+/*
+ * @docgen_start
+ * @type: function
+ * @name: area
+ * @brief: the first area
+ *
+ * @fparam: shape
+ * @type: struct Shape *
+ * @brief: the shape to measure
+ *
+ * @embed: Shape
+ * @show_brief: 0
+ *
+ * @return: int
+*/
+int area(struct Shape *shape);
+/* @docgen_end */
+
+/*
+ * @docgen_start
+ * @type: function
+ * @name: area
+ * @brief: the second area
+ *
+ * @return: int
+*/
+int area(void);
+/* @docgen_end */
+
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Shape
+ * @brief: the first shape
+ *
+ * @field: sides
+ * @type: int
+ * @brief: how many sides it has
+ * @docgen_end
+*/
+struct Shape { int sides; };
+
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Shape
+ * @brief: the second shape
+ *
+ * @field: corners
+ * @type: int
+ * @brief: how many corners it has
+ * @docgen_end
+*/
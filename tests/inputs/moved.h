@@ -0,0 +1,16 @@
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Point
+ * @brief: a point in three dimensions
+ *
+ * @field: z
+ * @type: int
+ * @brief: z coordinate
+ *
+ * @description
+ * @A point, which has moved to another file.
+ * @description
+ * @docgen_end
+*/
+struct Point { int z; };
@@ -0,0 +1,148 @@
+/*
+ * @author: someone, who maintains this file
+*/
+
+/*
+ * Copyright (c) someone
+*/
+
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Point
+ * @brief: a point in space
+ *
+ * @field: x
+ * @type: int
+ * @brief: x coordinate
+ *
+ * @struct_start
+ * @name: inner
+ * @brief: an inner struct
+ *
+ * @field: y
+ * @type: int *
+ * @brief: y coordinate
+ *
+ * @struct_end
+ *
+ * @description
+ * @A point.
+ * @description
+ * @docgen_end
+*/
+struct Point { int x; };
+
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: MAX_POINTS
+ * @brief: the maximum number of points
+ * @value: 100
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: function
+ * @name: point_add
+ * @brief: add two points
+ *
+ * @include: point.h
+ *
+ * @description
+ * @Adds two points together.
+ * @Second line of the description.
+ * @description
+ *
+ * @notes
+ * @Some notes here.
+ * @notes
+ *
+ * @examples
+ * @int main(void) {
+ * @    return 0;
+ * @}
+ * @examples
+ *
+ * @error: a is NULL
+ * @error: b is NULL
+ *
+ * @fparam: a
+ * @type: struct Point *
+ * @brief: the first point
+ *
+ * @fparam: b
+ * @type: struct Point
+ * @brief: the second point
+ *
+ * @embed: Point
+ * @show_brief: 1
+ *
+ * @embed: MAX_POINTS
+ * @show_brief: 0
+ *
+ * @return: struct Point
+ *
+ * @reference: point_sub(3)
+ * @reference: cware(cware)
+*/
+struct Point point_add(struct Point *a, struct Point b);
+/* @docgen_end */
+
+/*
+ * @docgen_start
+ * @type: macro_function
+ * @name: POINT_X
+ * @brief: get x
+ *
+ * @mparam: p
+ * @brief: the point to read
+ *
+ * @embed: Point
+ * @show_brief: 0
+ *
+ * @reference: point_add(3)
+ * @docgen_end
+*/
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Hidden
+ * @brief: a structure nobody embeds
+ *
+ * @field: x
+ * @type: int
+ * @brief: the x
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: UNUSED_LIMIT
+ * @brief: a constant nobody embeds
+ * @value: 3
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: structure
+ * @name: Hidden
+ * @brief: a structure nobody embeds
+ *
+ * @field: x
+ * @type: int
+ * @brief: the x
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: UNUSED_LIMIT
+ * @brief: a constant nobody embeds
+ * @value: 3
+ * @docgen_end
+*/
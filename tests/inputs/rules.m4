@@ -0,0 +1,33 @@
+dnl @author: someone, who maintains this file
+
+dnl @docgen_start
+dnl @type: macro
+dnl @name: NEW_RULE
+dnl @brief: make a new rule
+dnl
+dnl @include: m4ke.m4
+dnl
+dnl @description
+dnl @Create a new rule.
+dnl @description
+dnl
+dnl @error: no implicit rule
+dnl
+dnl @param: 1
+dnl @brief: the name of the file
+dnl
+dnl @param: 2
+dnl @brief: the input extension
+dnl
+dnl @embed: OTHER
+dnl @show_brief: 1
+dnl
+dnl @reference: m4(1)
+dnl @docgen_end
+define(`NEW_RULE', `$1')
+
+dnl @docgen_start
+dnl @type: macro
+dnl @name: OTHER
+dnl @brief: another macro
+dnl @docgen_end
@@ -0,0 +1,16 @@
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: CLOSED
+ * @brief: a block that is closed
+ * @value: 1
+ * @docgen_end
+*/
+
+/*
+ * @docgen_start
+ * @type: constant
+ * @name: UNCLOSED
+ * @brief: a block that is never closed
+ * @value: 2
+*/
@@ -0,0 +1,28 @@
+/*
+ * @docgen_start
+ * @type: function
+ * @name: point_scale
+ * @brief: scale a point
+ *
+ * @include: uses.h
+ *
+ * @description
+ * @Scales a point, which is documented in another file.
+ * @description
+ *
+ * @fparam: point
+ * @type: struct Point *
+ * @brief: the point to scale
+ *
+ * @fparam: factor
+ * @type: int
+ * @brief: how much to scale it by
+ *
+ * @embed: Point
+ * @show_brief: 1
+ *
+ * @embed: MAX_POINTS
+ * @show_brief: 0
+*/
+void point_scale(struct Point *point, int factor);
+/* @docgen_end */
@@ -0,0 +1,91 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Compiling and extracting on several threads, with --jobs. The output
+ * of each job is written in order, which must give exactly the same
+ * output as running on one thread.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("jobs") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_M4 " < " INPUT("rules.m4") " > rules.ex") == 0);
+
+    /* The same output as compiling on one thread */
+    assert(RUN(IN("jobs") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("jobs") COMPILER_C " --jobs 4 < point.ex > jobs.out") == 0);
+    assert(RUN(IN("jobs") "cmp batch.out jobs.out") == 0);
+
+    assert(RUN(IN("jobs") COMPILER_M4 " < rules.ex > batch-m4.out") == 0);
+    assert(RUN(IN("jobs") COMPILER_M4 " --jobs 2 < rules.ex > jobs-m4.out") == 0);
+    assert(RUN(IN("jobs") "cmp batch-m4.out jobs-m4.out") == 0);
+
+    /* Including when the tags are read from a source file */
+    assert(RUN(IN("jobs") COMPILER_C " --source " INPUT("point.h") " > source.out") == 0);
+    assert(RUN(IN("jobs") COMPILER_C " --jobs 4 --source " INPUT("point.h") " > source-jobs.out") == 0);
+    assert(RUN(IN("jobs") "cmp source.out source-jobs.out") == 0);
+
+    /* Extracting on several threads, from a large input whose blocks
+     * land on every side of where the input is cut up between them */
+    assert(RUN(IN("jobs") COPIES(300, INPUT("point.h")) " > many.h") == 0);
+    assert(RUN(IN("jobs") COPIES(300, INPUT("rules.m4")) " > many.m4") == 0);
+
+    assert(RUN(IN("jobs") EXTRACTOR_C " < many.h > many-h.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_C " --jobs 2 < many.h > many-h-2.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_C " --jobs 7 < many.h > many-h-7.ex") == 0);
+    assert(RUN(IN("jobs") "cmp many-h.ex many-h-2.ex && cmp many-h.ex many-h-7.ex") == 0);
+
+    assert(RUN(IN("jobs") EXTRACTOR_M4 " < many.m4 > many-m4.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_M4 " --jobs 2 < many.m4 > many-m4-2.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_M4 " --jobs 7 < many.m4 > many-m4-7.ex") == 0);
+    assert(RUN(IN("jobs") "cmp many-m4.ex many-m4-2.ex && cmp many-m4.ex many-m4-7.ex") == 0);
+
+    /* And from several files at once */
+    assert(RUN(IN("jobs") EXTRACTOR_C " many.h " INPUT("point.h") " many.h > files.ex") == 0);
+    assert(RUN(IN("jobs") EXTRACTOR_C " --jobs 4 many.h " INPUT("point.h") " many.h > files-jobs.ex") == 0);
+    assert(RUN(IN("jobs") "cmp files.ex files-jobs.ex") == 0);
+
+    /* Streaming compiles one block at a time */
+    assert(EXITS_WITH(IN("jobs") COMPILER_C " --jobs 2 --stream < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("jobs") COMPILER_C " --jobs 2 --pipeline < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("jobs") COMPILER_M4 " --jobs 2 --stream < rules.ex 2> /dev/null", 1) == 0);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Looking up the line of an offset in a text, with an index of where
+ * each of its lines starts. Every offset must be on the same line as
+ * counting the line endings before it says, whether or not the text
+ * ends with one, and however many empty lines it has.
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "../src/common/errors/errors.c"
+
+/* Check the line of every offset of a text against counting */
+void check_lines(const char *text, int line_count) {
+    int index = 0;
+    int length = (int) strlen(text);
+    struct CString body;
+    struct CommonErrorsLineIndex *line_starts = common_errors_index_lines(text, length);
+
+    body.contents = (char *) text;
+    body.length = length;
+    body.capacity = length + 1;
+
+    assert(carray_length(line_starts) == line_count);
+
+    for(index = 0; index < length; index++) {
+        assert(common_errors_find_line(line_starts, index) == common_errors_get_line(body, index));
+    }
+
+    common_errors_free_lines(line_starts);
+}
+
+int main(void) {
+    struct CommonErrorsLineIndex *line_starts = NULL;
+
+    check_lines("one line", 1);
+    check_lines("one line\n", 1);
+    check_lines("\n", 1);
+    check_lines("first\nsecond\nthird", 3);
+    check_lines("first\nsecond\nthird\n", 3);
+    check_lines("\n\nafter two empty lines\n\n\nbefore the end", 6);
+
+    /* An empty text has no lines */
+    line_starts = common_errors_index_lines("", 0);
+    assert(carray_length(line_starts) == 0);
+    common_errors_free_lines(line_starts);
+
+    /* The line ending belongs to the line it ends */
+    line_starts = common_errors_index_lines("ab\ncd\n", 6);
+    assert(common_errors_find_line(line_starts, 2) == 0);
+    assert(common_errors_find_line(line_starts, 3) == 1);
+    assert(common_errors_find_line(line_starts, 5) == 1);
+    common_errors_free_lines(line_starts);
+
+    return 0;
+}
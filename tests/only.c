@@ -0,0 +1,97 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Building a few manuals quickly, with --only, in the compilers and in
+ * the backend. The manuals that are built must be the same as when every
+ * manual is built, and no others are written.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("only") == 0);
+    assert(RUN(IN("only") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+    assert(RUN(IN("only") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("only") MANUALS("batch", "batch.out")) == 0);
+
+    /* Only compiling point_add, along with the embeds it requests */
+    assert(RUN(IN("only") COMPILER_C " --only point_add < point.ex > compiled.out") == 0);
+    assert(RUN(IN("only") MANUALS("compiled", "compiled.out")) == 0);
+    assert(RUN(IN("only") "test \"`ls compiled/doc`\" = point_add.3") == 0);
+    assert(RUN(IN("only") "cmp batch/doc/point_add.3 compiled/doc/point_add.3") == 0);
+
+    assert(RUN(IN("only") COMPILER_C " --only point_add --source " INPUT("point.h") " > source.out") == 0);
+    assert(RUN(IN("only") "cmp compiled.out source.out") == 0);
+
+    /* Only writing point_add and POINT_X */
+    assert(RUN(IN("only") MANUALS("written", "batch.out") " --only point_add,POINT_X") == 0);
+    assert(RUN(IN("only") "test `ls written/doc | wc -l` -eq 2") == 0);
+    assert(RUN(IN("only") "cmp batch/doc/point_add.3 written/doc/point_add.3") == 0);
+    assert(RUN(IN("only") "cmp batch/doc/POINT_X.3 written/doc/POINT_X.3") == 0);
+
+    /* Other blocks are skipped rather than validated, which streaming
+     * and checking cannot do */
+    assert(EXITS_WITH(IN("only") COMPILER_C " --only point_add --stream < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("only") COMPILER_C " --only point_add --pipeline < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("only") COMPILER_C " --only point_add --check < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("only") BACKEND " --only point_add --serve socket 2> /dev/null", 1) == 0);
+
+    /* Only compiling OTHER, in the m4 compiler, which leaves out the
+     * embed of NEW_RULE, but not the embed NEW_RULE requests */
+    assert(RUN(IN("only") EXTRACTOR_M4 " < " INPUT("rules.m4") " > rules.ex") == 0);
+    assert(RUN(IN("only") COMPILER_M4 " < rules.ex > rules.out") == 0);
+    assert(RUN(IN("only") MANUALS("rules", "rules.out")) == 0);
+    assert(RUN(IN("only") COMPILER_M4 " --only OTHER < rules.ex > other.out") == 0);
+    assert(RUN(IN("only") MANUALS("other", "other.out")) == 0);
+    assert(RUN(IN("only") "test \"`ls other/doc`\" = OTHER.3") == 0);
+    assert(RUN(IN("only") "cmp rules/doc/OTHER.3 other/doc/OTHER.3") == 0);
+    assert(RUN(IN("only") "grep 'START_EMBED NEW_RULE' other.out") != 0);
+
+    assert(RUN(IN("only") COMPILER_M4 " --only NEW_RULE < rules.ex > new_rule.out") == 0);
+    assert(RUN(IN("only") MANUALS("new_rule", "new_rule.out")) == 0);
+    assert(RUN(IN("only") "test \"`ls new_rule/doc`\" = NEW_RULE.3") == 0);
+    assert(RUN(IN("only") "cmp rules/doc/NEW_RULE.3 new_rule/doc/NEW_RULE.3") == 0);
+
+    assert(RUN(IN("only") COMPILER_M4 " --only NEW_RULE --source " INPUT("rules.m4") " > rules-source.out") == 0);
+    assert(RUN(IN("only") COMPILER_M4 " --only NEW_RULE --jobs 2 < rules.ex > rules-jobs.out") == 0);
+    assert(RUN(IN("only") "cmp new_rule.out rules-source.out && cmp new_rule.out rules-jobs.out") == 0);
+    assert(EXITS_WITH(IN("only") COMPILER_M4 " --only OTHER --stream < rules.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("only") COMPILER_M4 " --only OTHER --check < rules.ex 2> /dev/null", 1) == 0);
+
+    return 0;
+}
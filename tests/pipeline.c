@@ -0,0 +1,83 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Compiling in a pipeline, with --pipeline. Reading, compiling, and
+ * writing each happen on a thread of their own, which must give exactly
+ * the same output as --stream, even when the input has an error, and so
+ * the same manuals as compiling the whole input at once.
+*/
+
+#include "common.h"
+
+int main(void) {
+    int run_index = 0;
+
+    assert(WORK("pipeline") == 0);
+    assert(RUN(IN("pipeline") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+
+    /* The same output as streaming */
+    assert(RUN(IN("pipeline") COMPILER_C " --stream < point.ex > stream.out") == 0);
+    assert(RUN(IN("pipeline") COMPILER_C " --pipeline < point.ex > pipeline.out") == 0);
+    assert(RUN(IN("pipeline") "cmp stream.out pipeline.out") == 0);
+
+    assert(RUN(IN("pipeline") COMPILER_C " --pipeline --source " INPUT("point.h") " > source.out") == 0);
+    assert(RUN(IN("pipeline") "cmp stream.out source.out") == 0);
+
+    /* The same manuals as compiling all at once */
+    assert(RUN(IN("pipeline") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("pipeline") SAME_MANUALS("batch", "batch.out", "pipeline", "pipeline.out")) == 0);
+
+    /* An error after many blocks. Everything before it is written, and
+     * the error is reported once it is, with the same exit code as when
+     * streaming, every time */
+    assert(RUN(IN("pipeline") EXTRACTOR_C " < " INPUT("broken.h") " > broken.ex") == 0);
+    assert(RUN(IN("pipeline") COPIES(50, "point.ex") " > many.ex") == 0);
+    assert(RUN(IN("pipeline") "cat broken.ex point.ex >> many.ex") == 0);
+    assert(EXITS_WITH(IN("pipeline") COMPILER_C " --stream < many.ex > many-stream.out 2> many-stream.err", 11) == 0);
+
+    for(run_index = 0; run_index < 10; run_index++) {
+        assert(EXITS_WITH(IN("pipeline") COMPILER_C " --pipeline < many.ex > many-pipeline.out 2> many-pipeline.err", 11) == 0);
+        assert(RUN(IN("pipeline") "cmp many-stream.out many-pipeline.out") == 0);
+        assert(RUN(IN("pipeline") "cmp many-stream.err many-pipeline.err") == 0);
+    }
+
+    /* The pipeline only compiles, and compiles every block */
+    assert(EXITS_WITH(IN("pipeline") COMPILER_C " --pipeline --check < point.ex 2> /dev/null", 1) == 0);
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Building manuals on a server, with --serve and --client. A job must
+ * write the same manuals as a regular run, be compiled again once its
+ * source changes, and send back why the compiler failed when it does.
+*/
+
+#include "common.h"
+
+/* Run a job on the server of the test */
+#define CLIENT(source) BACKEND " --client \"$ROOT/tests/work/serve/socket\" --source " source
+
+int main(void) {
+    assert(WORK("serve") == 0);
+    assert(RUN(IN("serve") "mkdir -p bin && ln -s " COMPILER_C " bin/docgen-compiler-c") == 0);
+    assert(RUN(IN("serve") "cp " INPUT("point.h") " point.h && cp " INPUT("broken.h") " broken.h") == 0);
+    assert(RUN(IN("serve") EXTRACTOR_C " < point.h | " COMPILER_C " > point.out") == 0);
+    assert(RUN(IN("serve") MANUALS("batch", "point.out")) == 0);
+
+    /* The server finds the compilers on its PATH */
+    assert(RUN(IN("serve") "PATH=\"`pwd`/bin:$PATH\" " BACKEND " --serve \"`pwd`/socket\" < /dev/null > server.log 2>&1 & "
+               "echo $! > server.pid") == 0);
+    assert(RUN(IN("serve") "tries=0; while [ ! -S socket ] && [ $tries -lt 50 ]; do sleep 1; tries=$((tries + 1)); done; test -S socket") == 0);
+
+    /* The same manuals as a regular run, twice, the second time from the cache */
+    assert(RUN(IN("serve") "mkdir -p served/doc && cd served && " CLIENT("../point.h") " > ../first.list") == 0);
+    assert(RUN(IN("serve") "diff -r batch served") == 0);
+    assert(RUN(IN("serve") "rm -r served/doc && mkdir served/doc && cd served && " CLIENT("../point.h") " > ../second.list") == 0);
+    assert(RUN(IN("serve") "diff -r batch served") == 0);
+    assert(RUN(IN("serve") "cmp first.list second.list") == 0);
+
+    /* A source that changed is compiled again */
+    assert(RUN(IN("serve") "sed 's/a point in space/a point in the plane/' " INPUT("point.h") " > point.h") == 0);
+    assert(RUN(IN("serve") "cd served && " CLIENT("../point.h") " > /dev/null") == 0);
+    assert(RUN(IN("serve") "grep 'a point in the plane' served/doc/Point.3 > /dev/null") == 0);
+
+    /* A compiler that fails sends back what it wrote to its stderr */
+    assert(EXITS_WITH(IN("serve") "cd served && " CLIENT("../broken.h") " > /dev/null 2> ../broken.err", 1) == 0);
+    assert(RUN(IN("serve") "grep \"unrecognized tag '@bogus'\" broken.err > /dev/null") == 0);
+    assert(RUN(IN("serve") "grep \"compiler 'docgen-compiler-c' failed\" broken.err > /dev/null") == 0);
+    assert(RUN(IN("serve") "test ! -s server.log") == 0);
+
+    assert(RUN(IN("serve") "kill `cat server.pid`") == 0);
+
+    return 0;
+}
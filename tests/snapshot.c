@@ -0,0 +1,65 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Snapshots of built manuals, with --write-snapshot and --read-snapshot.
+ * The manuals written from a snapshot must be the same as the ones
+ * written while it was saved, and as ones built straight from the input.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("snapshot") == 0);
+    assert(RUN(IN("snapshot") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " > point.out") == 0);
+
+    assert(RUN(IN("snapshot") MANUALS("batch", "point.out")) == 0);
+    assert(RUN(IN("snapshot") MANUALS("saved", "point.out") " --write-snapshot ../point.snapshot") == 0);
+    assert(RUN(IN("snapshot") "mkdir -p restored/doc && cd restored && " BACKEND " --read-snapshot ../point.snapshot") == 0);
+    assert(RUN(IN("snapshot") "diff -r batch saved") == 0);
+    assert(RUN(IN("snapshot") "diff -r batch restored") == 0);
+
+    /* The formats are chosen when the snapshot is read */
+    assert(RUN(IN("snapshot") "mkdir -p formats/doc && cd formats && " BACKEND " --formats man,html,md < ../point.out") == 0);
+    assert(RUN(IN("snapshot") "mkdir -p formats-restored/doc && cd formats-restored && " BACKEND " --formats man,html,md --read-snapshot ../point.snapshot") == 0);
+    assert(RUN(IN("snapshot") "diff -r formats formats-restored") == 0);
+
+    /* Only snapshots are read */
+    assert(EXITS_WITH(IN("snapshot") BACKEND " --read-snapshot point.out 2> /dev/null", 1) == 0);
+
+    return 0;
+}
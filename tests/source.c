@@ -0,0 +1,63 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Compiling a source file straight away, with --source. The tags are read
+ * from the docgen blocks of the file, which must give the same output as
+ * compiling the output of an extractor, even when the file has tags
+ * outside of its docgen blocks.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("source") == 0);
+
+    /* point.h and rules.m4 both start with a comment naming an @author */
+    assert(RUN(IN("source") EXTRACTOR_C " < " INPUT("point.h") " | " COMPILER_C " > extracted.out") == 0);
+    assert(RUN(IN("source") COMPILER_C " --source " INPUT("point.h") " > source.out") == 0);
+    assert(RUN(IN("source") "cmp extracted.out source.out") == 0);
+
+    assert(RUN(IN("source") EXTRACTOR_M4 " < " INPUT("rules.m4") " | " COMPILER_M4 " > extracted-m4.out") == 0);
+    assert(RUN(IN("source") COMPILER_M4 " --source " INPUT("rules.m4") " > source-m4.out") == 0);
+    assert(RUN(IN("source") "cmp extracted-m4.out source-m4.out") == 0);
+
+    /* Errors are reported with the same code */
+    assert(EXITS_WITH(IN("source") COMPILER_C " --source " INPUT("broken.h") " > /dev/null 2> /dev/null", 11) == 0);
+
+    return 0;
+}
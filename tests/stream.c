@@ -0,0 +1,81 @@
+/*
+ * C-Ware License
+ * 
+ * Copyright (c) 2022, C-Ware
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * 3. Redistributions of modified source code must append a copyright notice in
+ *    the form of 'Copyright <YEAR> <NAME>' to each modified source file's
+ *    copyright notice, and the standalone license file if one exists.
+ * 
+ * A "redistribution" can be constituted as any version of the source code
+ * that is intended to comprise some other derivative work of this code. A
+ * fork created for the purpose of contributing to any version of the source
+ * does not constitute a truly "derivative work" and does not require listing.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Streaming compilation, with --stream. Each docgen block is compiled as
+ * soon as it ends, so its embeds come right after it rather than after
+ * every group, but the manuals written from it must be the same as the
+ * ones written from compiling the whole input at once.
+*/
+
+#include "common.h"
+
+int main(void) {
+    assert(WORK("stream") == 0);
+    assert(RUN(IN("stream") EXTRACTOR_C " < " INPUT("point.h") " > point.ex") == 0);
+    assert(RUN(IN("stream") EXTRACTOR_M4 " < " INPUT("rules.m4") " > rules.ex") == 0);
+
+    /* The same manuals as compiling all at once */
+    assert(RUN(IN("stream") COMPILER_C " < point.ex > batch.out") == 0);
+    assert(RUN(IN("stream") COMPILER_C " --stream < point.ex > stream.out") == 0);
+    assert(RUN(IN("stream") SAME_MANUALS("batch", "batch.out", "stream", "stream.out")) == 0);
+
+    assert(RUN(IN("stream") COMPILER_M4 " < rules.ex > batch-m4.out") == 0);
+    assert(RUN(IN("stream") COMPILER_M4 " --stream < rules.ex > stream-m4.out") == 0);
+    assert(RUN(IN("stream") SAME_MANUALS("batch-m4", "batch-m4.out", "stream-m4", "stream-m4.out")) == 0);
+
+    /* And from a large input, where names are documented over and over */
+    assert(RUN(IN("stream") COPIES(400, INPUT("point.h") " " INPUT("duplicates.h")) " | " EXTRACTOR_C " > many.ex") == 0);
+    assert(RUN(IN("stream") COMPILER_C " < many.ex > many-batch.out") == 0);
+    assert(RUN(IN("stream") COMPILER_C " --stream < many.ex > many-stream.out") == 0);
+    assert(RUN(IN("stream") SAME_MANUALS("many-batch", "many-batch.out", "many-stream", "many-stream.out")) == 0);
+
+    /* The blocks before an error are still written, and the error exits
+     * with the same code as it does when compiling all at once */
+    assert(RUN(IN("stream") EXTRACTOR_C " < " INPUT("broken.h") " > broken.ex") == 0);
+    assert(EXITS_WITH(IN("stream") COMPILER_C " < broken.ex > broken.out 2> /dev/null", 11) == 0);
+    assert(EXITS_WITH(IN("stream") COMPILER_C " --stream < broken.ex > broken.out 2> /dev/null", 11) == 0);
+    assert(RUN(IN("stream") "grep 'START_GROUP FIRST' broken.out > /dev/null") == 0);
+    assert(RUN(IN("stream") "grep 'START_GROUP LAST' broken.out > /dev/null") != 0);
+
+    /* Streaming only reads the output of an extractor */
+    assert(EXITS_WITH(IN("stream") COMPILER_C " --stream --source " INPUT("point.h") " 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("stream") COMPILER_C " --stream --check < point.ex 2> /dev/null", 1) == 0);
+    assert(EXITS_WITH(IN("stream") COMPILER_M4 " --stream --source " INPUT("rules.m4") " 2> /dev/null", 1) == 0);
+
+    return 0;
+}